@@ -2,15 +2,50 @@
 #include <iostream>
 #include <math.h>
 #include <string.h>
+#include <emmintrin.h>
+#ifdef WIN64
+#include <intrin.h>
+#define ATOMIC_OR8(p, v)  _InterlockedOr8((volatile char *)(p), (char)(v))
+#define ATOMIC_OR32(p, v) _InterlockedOr((volatile long *)(p), (long)(v))
+#else
+#define ATOMIC_OR8(p, v)  __sync_fetch_and_or((p), (v))
+#define ATOMIC_OR32(p, v) __sync_fetch_and_or((p), (v))
+#endif
 //#include <unistd.h>
 
 #define MAKESTRING(n) STRING(n)
 #define STRING(n) #n
 #define BLOOM_MAGIC "libbloom2"
-#define BLOOM_VERSION_MAJOR 2
-#define BLOOM_VERSION_MINOR 1
-
-Bloom::Bloom(unsigned long long entries, double error) : _ready(0)
+#define BLOOM_VERSION_MAJOR 3          // 64 bits probes and bit addresses
+#define BLOOM_VERSION_MINOR 1          // murmurhash2 probes
+#define BLOOM_VERSION_MINOR_DIRECT 2   // probes sliced from the key
+
+// bloom_check_add() modes
+#define BLOOM_CHECK 0
+#define BLOOM_ADD 1
+#define BLOOM_ADD_CONCURRENT 2         // atomic bit sets, several threads may add at once
+
+// Probes prefetched by prefetch(), a check of a missing key stops at the
+// first unset bit: after 2 probes in 3 cases out of 4
+#define BLOOM_PREFETCH_PROBES 2
+
+static const uint32_t bloom_salt[BLOOM_BLOCK_WORDS] = BLOOM_SALTS;
+
+// Parameters of a saved filter, after the magic and the header size
+typedef struct {
+    unsigned long long int entries;
+    unsigned long long int bits;
+    unsigned long long int bytes;
+    unsigned long long int blocks;
+    double error;
+    double bpe;
+    int format;
+    unsigned char hashes;
+    unsigned char major;
+    unsigned char minor;
+} BLOOM_HEADER;
+
+Bloom::Bloom(unsigned long long entries, double error, int format) : _ready(0), _mapped(0)
 {
     if (entries < 1000 || error <= 0 || error >= 1) {
         printf("Bloom init error\n");
@@ -19,50 +54,97 @@ Bloom::Bloom(unsigned long long entries, double error) : _ready(0)
 
     _entries = entries;
     _error = error;
+    _format = format;
 
     long double num = -log(_error);
     long double denom = 0.480453013918201; // ln(2)^2
     _bpe = (num / denom);
 
-    long double dentries = (long double)_entries;
-    long double allbits = dentries * _bpe;
-    _bits = (unsigned long long int)allbits;
+    if (BLOOM_LAYOUT(_format) == BLOOM_BLOCKED) {
+
+        // Keys of a block share its 512 bits, more bits per element are needed
+        // to reach the same error than the classic layout.
+        while (blocked_error(_bpe) > _error)
+            _bpe += 0.25;
+
+        _blocks = (unsigned long long int)ceil((long double)_entries * _bpe / BLOOM_BLOCK_BITS);
+        _bits = _blocks * BLOOM_BLOCK_BITS;
+        _bytes = _bits / 8;
+        _hashes = BLOOM_BLOCK_WORDS;
 
-    if (_bits % 8) {
-        _bytes = (unsigned long long int)(_bits / 8) + 1;
     } else {
-        _bytes = (unsigned long long int) _bits / 8;
-    }
 
-    _hashes = (unsigned char)ceil(0.693147180559945 * _bpe);  // ln(2)
+        long double dentries = (long double)_entries;
+        long double allbits = dentries * _bpe;
+        _bits = (unsigned long long int)allbits;
+
+        if (_bits % 8) {
+            _bytes = (unsigned long long int)(_bits / 8) + 1;
+        } else {
+            _bytes = (unsigned long long int) _bits / 8;
+        }
+
+        _blocks = 0;
+        _hashes = (unsigned char)ceil(0.693147180559945 * _bpe);  // ln(2)
 
-    _bf = (unsigned char *)calloc((unsigned long long int)_bytes, sizeof(unsigned char));
+    }
+
+    // Cache line aligned, a block of the blocked layout is a single line
+    _bf = (unsigned char *)_mm_malloc((size_t)_bytes, 64);
     if (_bf == NULL) {                                   // LCOV_EXCL_START
         printf("Bloom init error\n");
         return;
     }                                                          // LCOV_EXCL_STOP
+    memset(_bf, 0, (size_t)_bytes);
 
     _ready = 1;
 
     _major = BLOOM_VERSION_MAJOR;
-    _minor = BLOOM_VERSION_MINOR;
+    _minor = (_format & BLOOM_DIRECT) ? BLOOM_VERSION_MINOR_DIRECT : BLOOM_VERSION_MINOR;
 
 }
+Bloom::Bloom() : _entries(0), _bits(0), _bytes(0), _hashes(0), _error(0), _format(0), _blocks(0),
+    _ready(0), _mapped(0), _major(0), _minor(0), _bpe(0), _bf(NULL)
+{
+}
+
 Bloom::~Bloom()
 {
-    if (_ready)
-        free(_bf);
+    if (_ready && !_mapped)
+        _mm_free(_bf);
 }
 
 int Bloom::check(const void *buffer, int len)
 {
-    return bloom_check_add(buffer, len, 0);
+    return bloom_check_add(buffer, len, BLOOM_CHECK);
+}
+
+
+// Issues the loads of the lines check() will read first, a batch of keys is
+// prefetched some keys ahead of their check to overlap the cache misses
+void Bloom::prefetch(const void *buffer, int len)
+{
+    uint64_t a, b;
+    probes(buffer, len, a, b);
+
+    if (BLOOM_LAYOUT(_format) == BLOOM_BLOCKED) {
+        _mm_prefetch((const char *)(_bf + mulhi(a, _blocks) * 64), _MM_HINT_T0);
+        return;
+    }
+    for (int i = 0; i < BLOOM_PREFETCH_PROBES && i < _hashes; i++)
+        _mm_prefetch((const char *)(_bf + (mulhi(a + b * i, _bits) >> 3)), _MM_HINT_T0);
 }
 
 
 int Bloom::add(const void *buffer, int len)
 {
-    return bloom_check_add(buffer, len, 1);
+    return bloom_check_add(buffer, len, BLOOM_ADD);
+}
+
+
+int Bloom::add_concurrent(const void *buffer, int len)
+{
+    return bloom_check_add(buffer, len, BLOOM_ADD_CONCURRENT);
 }
 
 
@@ -73,6 +155,8 @@ void Bloom::print()
         printf(" *** NOT READY ***\n");
     }
     printf("  Version    : %d.%d\n", _major, _minor);
+    printf("  Layout     : %s\n", (BLOOM_LAYOUT(_format) == BLOOM_BLOCKED) ? "blocked (64 bytes)" : "classic");
+    printf("  Probes     : %s\n", (_format & BLOOM_DIRECT) ? "direct (key bits)" : "murmurhash2");
     printf("  Entries    : %llu\n", _entries);
     printf("  Error      : %1.10f\n", _error);
     printf("  Bits       : %llu\n", _bits);
@@ -95,134 +179,101 @@ int Bloom::reset()
 }
 
 
-int Bloom::save(const char *filename)
+int Bloom::save(FILE *f)
 {
-//    if (filename == NULL || filename[0] == 0) {
-//        return 1;
-//    }
-
-//    int fd = open(filename, O_WRONLY | O_CREAT, 0644);
-//    if (fd < 0) {
-//        return 1;
-//    }
-
-//    ssize_t out = write(fd, BLOOM_MAGIC, strlen(BLOOM_MAGIC));
-//    if (out != strlen(BLOOM_MAGIC)) {
-//        goto save_error;        // LCOV_EXCL_LINE
-//    }
-
-//    uint16_t size = sizeof(struct bloom);
-//    out = write(fd, &size, sizeof(uint16_t));
-//    if (out != sizeof(uint16_t)) {
-//        goto save_error;        // LCOV_EXCL_LINE
-//    }
-
-//    out = write(fd, bloom, sizeof(struct bloom));
-//    if (out != sizeof(struct bloom)) {
-//        goto save_error;        // LCOV_EXCL_LINE
-//    }
-
-//    out = write(fd, _bf, _bytes);
-//    if (out != _bytes) {
-//        goto save_error;        // LCOV_EXCL_LINE
-//    }
-
-//    close(fd);
-//    return 0;
-//    // LCOV_EXCL_START
-//save_error:
-//    close(fd);
-//    return 1;
-//    // LCOV_EXCL_STOP
+    if (!_ready) {
+        return 1;
+    }
+
+    BLOOM_HEADER h;
+    memset(&h, 0, sizeof(h));
+    h.entries = _entries;
+    h.bits = _bits;
+    h.bytes = _bytes;
+    h.blocks = _blocks;
+    h.error = _error;
+    h.bpe = _bpe;
+    h.format = _format;
+    h.hashes = _hashes;
+    h.major = _major;
+    h.minor = _minor;
+
+    unsigned char head[BLOOM_FILE_HEADER];
+    uint16_t size = sizeof(BLOOM_HEADER);
+    memset(head, 0, sizeof(head));
+    memcpy(head, BLOOM_MAGIC, strlen(BLOOM_MAGIC));
+    memcpy(head + 16, &size, sizeof(uint16_t));
+    memcpy(head + 24, &h, sizeof(h));
+
+    if (fwrite(head, 1, sizeof(head), f) != sizeof(head)) {
+        return 2;
+    }
+    if (fwrite(_bf, 1, (size_t)_bytes, f) != _bytes) {
+        return 3;
+    }
     return 0;
 }
 
 
-int Bloom::load(const char *filename)
+// The bits are used in place, buf must stay valid (and 64 bytes aligned)
+// for the life of the filter
+int Bloom::load(const unsigned char *buf, unsigned long long size)
 {
-//    int rv = 0;
-
-//    if (filename == NULL || filename[0] == 0) {
-//        return 1;
-//    }
-//    if (bloom == NULL) {
-//        return 2;
-//    }
-
-//    memset(bloom, 0, sizeof(struct bloom));
-
-//    int fd = open(filename, O_RDONLY);
-//    if (fd < 0) {
-//        return 3;
-//    }
-
-//    char line[30];
-//    memset(line, 0, 30);
-//    ssize_t in = read(fd, line, strlen(BLOOM_MAGIC));
-
-//    if (in != strlen(BLOOM_MAGIC)) {
-//        rv = 4;
-//        goto load_error;
-//    }
-
-//    if (strncmp(line, BLOOM_MAGIC, strlen(BLOOM_MAGIC))) {
-//        rv = 5;
-//        goto load_error;
-//    }
-
-//    uint16_t size;
-//    in = read(fd, &size, sizeof(uint16_t));
-//    if (in != sizeof(uint16_t)) {
-//        rv = 6;
-//        goto load_error;
-//    }
-
-//    if (size != sizeof(struct bloom)) {
-//        rv = 7;
-//        goto load_error;
-//    }
-
-//    in = read(fd, bloom, sizeof(struct bloom));
-//    if (in != sizeof(struct bloom)) {
-//        rv = 8;
-//        goto load_error;
-//    }
-
-//    _bf = NULL;
-//    if (_major != BLOOM_VERSION_MAJOR) {
-//        rv = 9;
-//        goto load_error;
-//    }
-
-//    _bf = (unsigned char *)malloc(_bytes);
-//    if (_bf == NULL) {
-//        rv = 10;        // LCOV_EXCL_LINE
-//        goto load_error;
-//    }
-
-//    in = read(fd, _bf, _bytes);
-//    if (in != _bytes) {
-//        rv = 11;
-//        free(_bf);
-//        _bf = NULL;
-//        goto load_error;
-//    }
-
-//    close(fd);
-//    return rv;
-
-//load_error:
-//    close(fd);
-//    _ready = 0;
-//    return rv;
+    if (_ready) {
+        return 1;
+    }
+    if (size < BLOOM_FILE_HEADER || memcmp(buf, BLOOM_MAGIC, strlen(BLOOM_MAGIC)) != 0) {
+        return 2;
+    }
+
+    uint16_t hsize;
+    memcpy(&hsize, buf + 16, sizeof(uint16_t));
+    if (hsize != sizeof(BLOOM_HEADER)) {
+        return 3;
+    }
+
+    BLOOM_HEADER h;
+    memcpy(&h, buf + 24, sizeof(h));
+    if (h.major != BLOOM_VERSION_MAJOR) {
+        return 4;
+    }
+    if (size < BLOOM_FILE_HEADER + h.bytes) {
+        return 5;
+    }
+
+    _entries = h.entries;
+    _bits = h.bits;
+    _bytes = h.bytes;
+    _blocks = h.blocks;
+    _error = h.error;
+    _bpe = h.bpe;
+    _format = h.format;
+    _hashes = h.hashes;
+    _major = h.major;
+    _minor = h.minor;
+    _bf = (unsigned char *)buf + BLOOM_FILE_HEADER;
+    _mapped = 1;
+    _ready = 1;
     return 0;
 }
 
 
+unsigned long long int Bloom::get_entries()
+{
+    return _entries;
+}
 unsigned char Bloom::get_hashes()
 {
     return _hashes;
 }
+int Bloom::get_format()
+{
+    return _format;
+}
+int Bloom::get_version()
+{
+    return (_major << 8) | _minor;
+}
 unsigned long long int Bloom::get_bits()
 {
     return _bits;
@@ -236,16 +287,18 @@ const unsigned char *Bloom::get_bf()
     return _bf;
 }
 
-int Bloom::test_bit_set_bit(unsigned char *buf, unsigned int bit, int set_bit)
+int Bloom::test_bit_set_bit(unsigned char *buf, uint64_t bit, int set_bit)
 {
-    unsigned int byte = bit >> 3;
+    uint64_t byte = bit >> 3;
     unsigned char c = buf[byte];        // expensive memory access
     unsigned char mask = 1 << (bit % 8);
 
     if (c & mask) {
         return 1;
     } else {
-        if (set_bit) {
+        if (set_bit == BLOOM_ADD_CONCURRENT) {
+            ATOMIC_OR8(buf + byte, mask);
+        } else if (set_bit) {
             buf[byte] = c | mask;
         }
         return 0;
@@ -259,14 +312,19 @@ int Bloom::bloom_check_add(const void *buffer, int len, int add)
         return -1;
     }
 
+    uint64_t a, b;
+    probes(buffer, len, a, b);
+
+    if (BLOOM_LAYOUT(_format) == BLOOM_BLOCKED)
+        return blocked_check_add(a, (uint32_t)b, add);
+
     unsigned char hits = 0;
-    unsigned int a = murmurhash2(buffer, len, 0x9747b28c);
-    unsigned int b = murmurhash2(buffer, len, a);
-    unsigned int x;
+    uint64_t x;
     unsigned char i;
 
+    // Probe i mapped on [0, _bits) by a 64x64 bits multiply, no modulo
     for (i = 0; i < _hashes; i++) {
-        x = (a + b * i) % _bits;
+        x = mulhi(a + b * i, _bits);
         if (test_bit_set_bit(_bf, x, add)) {
             hits++;
         } else if (!add) {
@@ -282,6 +340,98 @@ int Bloom::bloom_check_add(const void *buffer, int len, int add)
     return 0;
 }
 
+// Offsets of the bytes holding the bits of a key, add() sets bits in these
+// only. Used to copy the bits of a key added during the search to the GPU.
+void Bloom::touched(const void *buffer, int len, std::vector<uint64_t> &offsets)
+{
+    uint64_t a, b;
+    probes(buffer, len, a, b);
+
+    if (BLOOM_LAYOUT(_format) == BLOOM_BLOCKED) {
+        uint64_t blk = mulhi(a, _blocks) * 64;
+        for (int i = 0; i < 64; i++)
+            offsets.push_back(blk + i);
+        return;
+    }
+    for (int i = 0; i < _hashes; i++)
+        offsets.push_back(mulhi(a + b * i, _bits) >> 3);
+}
+
+// Seeds of the double hashing. Hash160 and x coordinates are already uniformly
+// distributed, the direct format slices them instead of hashing them again.
+void Bloom::probes(const void *buffer, int len, uint64_t &a, uint64_t &b)
+{
+    if (_format & BLOOM_DIRECT) {
+        memcpy(&a, (const unsigned char *)buffer, 8);
+        memcpy(&b, (const unsigned char *)buffer + 8, 8);
+    } else {
+        uint32_t h1 = murmurhash2(buffer, len, 0x9747b28c);
+        uint32_t h2 = murmurhash2(buffer, len, h1);
+        a = ((uint64_t)h2 << 32) | h1;
+        // fmix64 of a
+        b = a ^ (a >> 33);
+        b *= 0xff51afd7ed558ccdULL;
+        b ^= b >> 33;
+        b *= 0xc4ceb9fe1a85ec53ULL;
+        b ^= b >> 33;
+    }
+}
+
+uint64_t Bloom::mulhi(uint64_t a, uint64_t b)
+{
+#ifdef WIN64
+    return __umulh(a, b);
+#else
+    return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#endif
+}
+
+// Blocked layout: the first hash selects a 64 bytes block, the second one sets
+// one bit in each of its 16 words (split block Bloom filter). A query costs a
+// single cache miss and the 16 bits are tested at once with SSE2.
+int Bloom::blocked_check_add(uint64_t a, uint32_t b, int add)
+{
+    __m128i *blk = (__m128i *)(_bf + mulhi(a, _blocks) * 64);
+    __m128i hit = _mm_set1_epi32(-1);
+    uint32_t m[BLOOM_BLOCK_WORDS];
+
+    for (int i = 0; i < BLOOM_BLOCK_WORDS; i++)
+        m[i] = 1U << ((b * bloom_salt[i]) >> 27);
+
+    for (int i = 0; i < 4; i++) {
+        __m128i mi = _mm_loadu_si128((__m128i *)(m + 4 * i));
+        __m128i bi = _mm_load_si128(blk + i);
+        hit = _mm_and_si128(hit, _mm_cmpeq_epi32(_mm_and_si128(bi, mi), mi));
+        if (add == BLOOM_ADD)
+            _mm_store_si128(blk + i, _mm_or_si128(bi, mi));
+    }
+
+    if (add == BLOOM_ADD_CONCURRENT) {
+        uint32_t *w = (uint32_t *)blk;
+        for (int i = 0; i < BLOOM_BLOCK_WORDS; i++) {
+            if ((w[i] & m[i]) == 0)
+                ATOMIC_OR32(w + i, m[i]);
+        }
+    }
+
+    // 1 == element already in (or collision)
+    return _mm_movemask_epi8(hit) == 0xFFFF;
+}
+
+// False positive rate of the blocked layout for bpe bits per element,
+// the number of keys in a block follows a Poisson distribution.
+double Bloom::blocked_error(double bpe)
+{
+    double mu = BLOOM_BLOCK_BITS / bpe;
+    double w = BLOOM_BLOCK_BITS / BLOOM_BLOCK_WORDS;
+    double fpr = 0;
+    for (int j = 0; j < 256; j++) {
+        double p = exp(-mu + j * log(mu) - lgamma(j + 1.0));
+        fpr += p * pow(1.0 - pow(1.0 - 1.0 / w, j), BLOOM_BLOCK_WORDS);
+    }
+    return fpr;
+}
+
 // MurmurHash2, by Austin Appleby
 
 // Note - This code makes a few assumptions about how your machine behaves -
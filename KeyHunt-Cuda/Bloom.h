@@ -1,28 +1,64 @@
 #ifndef BLOOMFILTER_H
 #define BLOOMFILTER_H
 
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+// Filter layouts
+#define BLOOM_CLASSIC 0   // k bits spread over the whole filter
+#define BLOOM_BLOCKED 1   // one 64 bytes block per key, one bit in each of its 16 words
+
+// Probe derivation, or-ed with the layout
+#define BLOOM_MURMUR 0x00   // two murmurhash2 passes over the key, expanded to 64 bits (version 3.1)
+#define BLOOM_DIRECT 0x10   // first two 64 bits words of the key, which must already be a hash (version 3.2)
+
+#define BLOOM_LAYOUT(format) ((format) & 0x0F)
+
+// Saved filter: magic, header and parameters, then the bits on a cache line
+#define BLOOM_FILE_HEADER 128
+
+#define BLOOM_BLOCK_BITS  512
+#define BLOOM_BLOCK_WORDS 16
+
+// Odd multipliers giving the bit of each word of a block (shared with the GPU)
+#define BLOOM_SALTS { \
+    0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31, \
+    0x9e3779b1, 0x85ebca77, 0xc2b2ae3d, 0x27d4eb2f, 0x165667b1, 0xcc9e2d51, 0x1b873593, 0x5bd1e995 }
+
 
 class Bloom
 {
 public:
-    Bloom(unsigned long long int entries, double error);
+    Bloom(unsigned long long int entries, double error, int format = BLOOM_CLASSIC);
+    Bloom();    // empty, see load()
     ~Bloom();
     int check(const void *buffer, int len);
+    void prefetch(const void *buffer, int len);
     int add(const void *buffer, int len);
+    int add_concurrent(const void *buffer, int len);
+    void touched(const void *buffer, int len, std::vector<uint64_t> &offsets);
     void print();
     int reset();
-    int save(const char *filename);
-    int load(const char *filename);
+    int save(FILE *f);
+    int load(const unsigned char *buf, unsigned long long int size);
 
+    unsigned long long int get_entries();
     unsigned char get_hashes();
+    int get_format();
+    int get_version();
     unsigned long long int get_bits();
     unsigned long long int get_bytes();
     const unsigned char *get_bf();
 
 private:
     static unsigned int murmurhash2(const void *key, int len, const unsigned int seed);
-    int test_bit_set_bit(unsigned char *buf, unsigned int bit, int set_bit);
+    int test_bit_set_bit(unsigned char *buf, uint64_t bit, int set_bit);
+    void probes(const void *buffer, int len, uint64_t &a, uint64_t &b);
+    static uint64_t mulhi(uint64_t a, uint64_t b);
     int bloom_check_add(const void *buffer, int len, int add);
+    int blocked_check_add(uint64_t a, uint32_t b, int add);
+    static double blocked_error(double bpe);
 
 private:
     // These fields are part of the public interface of this structure.
@@ -33,11 +69,14 @@ private:
     unsigned long long int _bytes;
     unsigned char _hashes;
     double _error;
+    int _format;
+    unsigned long long int _blocks;
 
     // Fields below are private to the implementation. These may go away or
     // change incompatibly at any moment. Client code MUST NOT access or rely
     // on these.
     unsigned char _ready;
+    unsigned char _mapped;      // _bf points in a loaded buffer, not owned
     unsigned char _major;
     unsigned char _minor;
     double _bpe;
@@ -0,0 +1,266 @@
+#include "FilterCache.h"
+#include "TargetSort.h"
+#include "Bloom.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN64
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// On-disk header, the first page of the file
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t sections;
+    CACHE_KEY key;
+    uint64_t offset[CACHE_SECTIONS];
+    uint64_t length[CACHE_SECTIONS];
+} CACHE_HEADER;
+
+static const char *cacheNames[] = { "bloom", "blocked", "fuse8", "fuse16" };
+
+FilterCache::FilterCache(const std::string &targetFile, int format, int len, const uint8_t *data, uint64_t size, int nbThread)
+{
+    init(targetFile, format, len, size, TargetsHash(data, size, nbThread));
+}
+
+// Content hash already known (see MergeTargetFile())
+FilterCache::FilterCache(const std::string &targetFile, int format, int len, uint64_t size, uint64_t hash)
+{
+    init(targetFile, format, len, size, hash);
+}
+
+void FilterCache::init(const std::string &targetFile, int format, int len, uint64_t size, uint64_t hash)
+{
+    int layout = BLOOM_LAYOUT(format);
+    _fileName = targetFile + "." + ((layout < 4) ? cacheNames[layout] : "filter") + ".cache";
+    _map = NULL;
+    _mapSize = 0;
+    _current = -1;
+    memset(_offset, 0, sizeof(_offset));
+    memset(_length, 0, sizeof(_length));
+
+    memset(&_key, 0, sizeof(_key));
+    _key.size = size;
+    _key.format = format;
+    _key.len = len;
+    _key.mtime = file_time(targetFile);
+    _key.hash = hash;
+}
+
+uint64_t FilterCache::file_time(const std::string &fileName)
+{
+#ifdef WIN64
+    struct __stat64 st;
+    if (_stat64(fileName.c_str(), &st) == 0)
+        return (uint64_t)st.st_mtime;
+#else
+    struct stat st;
+    if (stat(fileName.c_str(), &st) == 0)
+        return (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+    return 0;
+}
+
+FilterCache::~FilterCache()
+{
+    unmap();
+}
+
+std::string FilterCache::get_file_name()
+{
+    return _fileName;
+}
+
+bool FilterCache::load(bool update)
+{
+    unmap();
+
+#ifdef WIN64
+    _file = CreateFileA(_fileName.c_str(), update ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        update ? 0 : FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    GetFileSizeEx(_file, &size);
+    _mapSize = (uint64_t)size.QuadPart;
+    _mapping = CreateFileMapping(_file, NULL, update ? PAGE_READWRITE : PAGE_WRITECOPY, 0, 0, NULL);
+    _map = _mapping ? (unsigned char *)MapViewOfFile(_mapping, update ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, 0) : NULL;
+    if (_map == NULL) {
+        if (_mapping)
+            CloseHandle(_mapping);
+        CloseHandle(_file);
+        return false;
+    }
+#else
+    int fd = open(_fileName.c_str(), update ? O_RDWR : O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    fstat(fd, &st);
+    _mapSize = (uint64_t)st.st_size;
+    void *m = (_mapSize > 0) ? mmap(NULL, _mapSize, PROT_READ | PROT_WRITE, update ? MAP_SHARED : MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (m == MAP_FAILED)
+        return false;
+    _map = (unsigned char *)m;
+    madvise(_map, _mapSize, MADV_WILLNEED);
+#endif
+
+    CACHE_HEADER h;
+    bool ok = (_mapSize >= CACHE_ALIGN);
+    if (ok) {
+        memcpy(&h, _map, sizeof(h));
+        ok = memcmp(h.magic, CACHE_MAGIC, strlen(CACHE_MAGIC)) == 0 && h.version == CACHE_VERSION &&
+             h.sections == CACHE_SECTIONS && memcmp(&h.key, &_key, sizeof(CACHE_KEY)) == 0;
+    }
+    for (int i = 0; ok && i < CACHE_SECTIONS; i++)
+        ok = h.offset[i] >= CACHE_ALIGN && h.offset[i] <= _mapSize && h.length[i] <= _mapSize - h.offset[i];
+    if (!ok) {
+        unmap();
+        return false;
+    }
+
+    memcpy(_offset, h.offset, sizeof(_offset));
+    memcpy(_length, h.length, sizeof(_length));
+    return true;
+}
+
+const unsigned char *FilterCache::get_section(int id, unsigned long long int *size)
+{
+    if (_map == NULL || id < 0 || id >= CACHE_SECTIONS)
+        return NULL;
+    *size = _length[id];
+    return _map + _offset[id];
+}
+
+// The sections are flushed before the header, a cache left with the old
+// fingerprint is rebuilt on the next start
+bool FilterCache::rekey(const std::string &targetFile, uint64_t size, uint64_t hash)
+{
+    if (_map == NULL)
+        return false;
+
+#ifdef WIN64
+    bool ok = FlushViewOfFile(_map, 0) != 0;
+#else
+    bool ok = msync(_map, _mapSize, MS_SYNC) == 0;
+#endif
+    if (ok) {
+        _key.size = size;
+        _key.mtime = file_time(targetFile);
+        _key.hash = hash;
+        CACHE_HEADER h;
+        memcpy(&h, _map, sizeof(h));
+        h.key = _key;
+        memcpy(_map, &h, sizeof(h));
+#ifdef WIN64
+        ok = FlushViewOfFile(_map, 0) != 0;
+#else
+        ok = msync(_map, _mapSize, MS_SYNC) == 0;
+#endif
+    }
+    unmap();
+    return ok;
+}
+
+void FilterCache::unmap()
+{
+    if (_map == NULL)
+        return;
+#ifdef WIN64
+    UnmapViewOfFile(_map);
+    CloseHandle(_mapping);
+    CloseHandle(_file);
+#else
+    munmap(_map, _mapSize);
+#endif
+    _map = NULL;
+    _mapSize = 0;
+}
+
+uint64_t FilterCache::tell(FILE *f)
+{
+#ifdef WIN64
+    return (uint64_t)_ftelli64(f);
+#else
+    return (uint64_t)ftello(f);
+#endif
+}
+
+FILE *FilterCache::create()
+{
+    FILE *f = fopen((_fileName + ".tmp").c_str(), "wb");
+    if (f == NULL)
+        return NULL;
+
+    // Header page, written by commit()
+    static const unsigned char zero[CACHE_ALIGN] = { 0 };
+    if (fwrite(zero, 1, CACHE_ALIGN, f) != CACHE_ALIGN) {
+        discard(f);
+        return NULL;
+    }
+    memset(_offset, 0, sizeof(_offset));
+    memset(_length, 0, sizeof(_length));
+    _current = -1;
+    return f;
+}
+
+bool FilterCache::section(FILE *f, int id)
+{
+    static const unsigned char zero[CACHE_ALIGN] = { 0 };
+    uint64_t pos = tell(f);
+    if (_current >= 0)
+        _length[_current] = pos - _offset[_current];
+    size_t pad = (size_t)((CACHE_ALIGN - pos % CACHE_ALIGN) % CACHE_ALIGN);
+    if (fwrite(zero, 1, pad, f) != pad)
+        return false;
+    _offset[id] = pos + pad;
+    _current = id;
+    return true;
+}
+
+bool FilterCache::commit(FILE *f)
+{
+    if (_current >= 0)
+        _length[_current] = tell(f) - _offset[_current];
+    _current = -1;
+
+    CACHE_HEADER h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, CACHE_MAGIC, strlen(CACHE_MAGIC));
+    h.version = CACHE_VERSION;
+    h.sections = CACHE_SECTIONS;
+    h.key = _key;
+    memcpy(h.offset, _offset, sizeof(_offset));
+    memcpy(h.length, _length, sizeof(_length));
+
+    rewind(f);
+    if (fwrite(&h, 1, sizeof(h), f) != sizeof(h) || fclose(f) != 0) {
+        remove((_fileName + ".tmp").c_str());
+        return false;
+    }
+
+    // The previous cache may still be mapped
+    unmap();
+#ifdef WIN64
+    if (!MoveFileExA((_fileName + ".tmp").c_str(), _fileName.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (rename((_fileName + ".tmp").c_str(), _fileName.c_str()) != 0) {
+#endif
+        remove((_fileName + ".tmp").c_str());
+        return false;
+    }
+    return true;
+}
+
+void FilterCache::discard(FILE *f)
+{
+    fclose(f);
+    remove((_fileName + ".tmp").c_str());
+    _current = -1;
+}
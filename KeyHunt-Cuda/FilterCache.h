@@ -0,0 +1,77 @@
+#ifndef FILTERCACHE_H
+#define FILTERCACHE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#ifdef WIN64
+#include <Windows.h>
+#endif
+
+#define CACHE_MAGIC "KHCACHE"
+#define CACHE_VERSION 1
+#define CACHE_ALIGN 4096    // sections start on a page
+
+// Sections of a cache file
+#define CACHE_FILTER 0      // Bloom::save() or FuseFilter::save()
+#define CACHE_INDEX  1      // TargetIndex::save()
+#define CACHE_SECTIONS 2
+
+// Fingerprint of the target file and of the filter built from it
+typedef struct {
+    uint64_t size;
+    uint64_t mtime;
+    uint64_t hash;      // TargetsHash() of the content
+    int32_t format;     // filter format word
+    int32_t len;        // record length
+} CACHE_KEY;
+
+// Prebuilt filter and index of a target file, saved next to it as
+// <file>.<filter>.cache and mapped on the next starts while the fingerprint
+// matches. The sections are used in place from a copy on write mapping.
+class FilterCache
+{
+public:
+    FilterCache(const std::string &targetFile, int format, int len, const uint8_t *data, uint64_t size, int nbThread);
+    FilterCache(const std::string &targetFile, int format, int len, uint64_t size, uint64_t hash);
+    ~FilterCache();
+
+    // Map the cache file, false if it is missing or was built from other targets.
+    // With update the mapping is shared, the sections are modified in the file.
+    bool load(bool update = false);
+    const unsigned char *get_section(int id, unsigned long long int *size);
+
+    // Fingerprint of the updated target file written in a cache loaded for
+    // update, which is then unmapped
+    bool rekey(const std::string &targetFile, uint64_t size, uint64_t hash);
+
+    // Write a new cache: create(), section() before each section is saved, then
+    // commit() to replace the cache file or discard() on error
+    FILE *create();
+    bool section(FILE *f, int id);
+    bool commit(FILE *f);
+    void discard(FILE *f);
+
+    std::string get_file_name();
+
+private:
+    void init(const std::string &targetFile, int format, int len, uint64_t size, uint64_t hash);
+    void unmap();
+    static uint64_t file_time(const std::string &fileName);
+    static uint64_t tell(FILE *f);
+
+private:
+    std::string _fileName;
+    CACHE_KEY _key;
+    uint64_t _offset[CACHE_SECTIONS];
+    uint64_t _length[CACHE_SECTIONS];
+    int _current;               // section being written
+    unsigned char *_map;
+    uint64_t _mapSize;
+#ifdef WIN64
+    HANDLE _file;
+    HANDLE _mapping;
+#endif
+};
+
+#endif // FILTERCACHE_H
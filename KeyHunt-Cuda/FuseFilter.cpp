@@ -0,0 +1,440 @@
+#include "FuseFilter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <xmmintrin.h>
+#ifdef WIN64
+#include <intrin.h>
+#endif
+
+#define FUSE_MAX_ITERATIONS 100
+
+// Parameters of a saved filter, after the magic and the header size
+typedef struct {
+    unsigned long long int entries;
+    unsigned long long int bytes;
+    uint64_t seed;
+    uint32_t segmentLength;
+    uint32_t segmentCount;
+    uint32_t segmentCountLength;
+    uint32_t arrayLength;
+    int format;
+} FUSE_HEADER;
+
+FuseFilter::FuseFilter(const uint8_t *data, uint64_t count, int len, int format) : _format(format), _entries(count),
+    _seed(0), _segmentLength(0), _segmentLengthMask(0), _segmentCount(0), _segmentCountLength(0), _arrayLength(0),
+    _bytes(0), _fp(NULL), _ready(0), _mapped(0)
+{
+    if (count < 2 || count > 0xFFFFFFFFULL || len < 8) {
+        printf("Fuse filter init error\n");
+        return;
+    }
+
+    // 64 bits keys, targets sharing their first 8 bytes are adjacent in the
+    // sorted array and map to the same fingerprint
+    uint64_t *keys = (uint64_t *)malloc((size_t)count * sizeof(uint64_t));
+    if (keys == NULL) {
+        printf("Fuse filter init error\n");
+        return;
+    }
+    for (uint64_t i = 0; i < count; i++)
+        memcpy(keys + i, data + i * len, 8);
+    uint32_t size = (uint32_t)(std::unique(keys, keys + count) - keys);
+    if (size < 2) {
+        printf("Fuse filter init error\n");
+        free(keys);
+        return;
+    }
+
+    // Segment sizing of the 3-wise binary fuse filter
+    _segmentLength = 1U << (int)floor(log((double)size) / log(3.33) + 2.25);
+    if (_segmentLength > 262144)
+        _segmentLength = 262144;
+    _segmentLengthMask = _segmentLength - 1;
+    double sizeFactor = fmax(1.125, 0.875 + 0.25 * log(1000000.0) / log((double)size));
+    uint32_t capacity = (uint32_t)round((double)size * sizeFactor);
+    uint32_t initSegmentCount = (capacity + _segmentLength - 1) / _segmentLength - 2;
+    _arrayLength = (initSegmentCount + 2) * _segmentLength;
+    _segmentCount = (_arrayLength + _segmentLength - 1) / _segmentLength;
+    if (_segmentCount <= 2)
+        _segmentCount = 1;
+    else
+        _segmentCount = _segmentCount - 2;
+    _arrayLength = (_segmentCount + 2) * _segmentLength;
+    _segmentCountLength = _segmentCount * _segmentLength;
+
+    _bytes = (unsigned long long int)_arrayLength * ((_format == FILTER_FUSE16) ? 2 : 1);
+    _fp = (unsigned char *)calloc((size_t)_bytes, 1);
+    if (_fp == NULL) {
+        printf("Fuse filter init error\n");
+        _bytes = 0;
+        free(keys);
+        return;
+    }
+
+    bool ok = populate(keys, size);
+    free(keys);
+    if (!ok) {
+        printf("Fuse filter construction failed\n");
+        free(_fp);
+        _fp = NULL;
+        _bytes = 0;
+        return;
+    }
+
+    _ready = 1;
+}
+
+FuseFilter::FuseFilter() : _format(0), _entries(0), _seed(0), _segmentLength(0), _segmentLengthMask(0),
+    _segmentCount(0), _segmentCountLength(0), _arrayLength(0), _bytes(0), _fp(NULL), _ready(0), _mapped(0)
+{
+}
+
+FuseFilter::~FuseFilter()
+{
+    if (_ready && !_mapped)
+        free(_fp);
+}
+
+// Hash of the key and its 3 fingerprint positions
+uint64_t FuseFilter::positions(const void *buffer, uint32_t *h)
+{
+    uint64_t key;
+    memcpy(&key, buffer, 8);
+    uint64_t hash = mix(key + _seed);
+    uint64_t hi = mulhi(hash, _segmentCountLength);
+    h[0] = (uint32_t)hi;
+    h[1] = h[0] + _segmentLength;
+    h[2] = h[1] + _segmentLength;
+    h[1] ^= (uint32_t)(hash >> 18) & _segmentLengthMask;
+    h[2] ^= (uint32_t)(hash) & _segmentLengthMask;
+    return hash;
+}
+
+int FuseFilter::check(const void *buffer, int len)
+{
+    if (!_ready)
+        return 0;
+
+    uint32_t h[3];
+    uint64_t hash = positions(buffer, h);
+
+    if (_format == FILTER_FUSE16) {
+        const uint16_t *fp = (const uint16_t *)_fp;
+        uint16_t f = (uint16_t)(hash ^ (hash >> 32));
+        return (f ^ fp[h[0]] ^ fp[h[1]] ^ fp[h[2]]) == 0;
+    }
+
+    uint8_t f = (uint8_t)(hash ^ (hash >> 32));
+    return (f ^ _fp[h[0]] ^ _fp[h[1]] ^ _fp[h[2]]) == 0;
+}
+
+// The 3 fingerprints are in 3 different segments, one miss each
+void FuseFilter::prefetch(const void *buffer, int len)
+{
+    if (!_ready)
+        return;
+
+    uint32_t h[3];
+    positions(buffer, h);
+    int shift = (_format == FILTER_FUSE16) ? 1 : 0;
+    for (int i = 0; i < 3; i++)
+        _mm_prefetch((const char *)(_fp + ((uint64_t)h[i] << shift)), _MM_HINT_T0);
+}
+
+void FuseFilter::print()
+{
+    printf("Fuse filter at %p\n", (void *)this);
+    if (!_ready) {
+        printf(" *** NOT READY ***\n");
+    }
+    int fpBits = (_format == FILTER_FUSE16) ? 16 : 8;
+    printf("  Entries    : %llu\n", _entries);
+    printf("  Error      : %1.10f\n", 1.0 / (double)(1 << fpBits));
+    printf("  Fingerprint: %d bits\n", fpBits);
+    printf("  Segments   : %u x %u\n", _segmentCount + 2, _segmentLength);
+    printf("  Bits/Elem  : %f\n", (double)_bytes * 8.0 / (double)_entries);
+    printf("  Bytes      : %llu", _bytes);
+    unsigned int MB = (unsigned int)(_bytes / (1024 * 1024));
+    printf(" (%u MB)\n", MB);
+}
+
+int FuseFilter::save(FILE *f)
+{
+    if (!_ready)
+        return 1;
+
+    FUSE_HEADER h;
+    memset(&h, 0, sizeof(h));
+    h.entries = _entries;
+    h.bytes = _bytes;
+    h.seed = _seed;
+    h.segmentLength = _segmentLength;
+    h.segmentCount = _segmentCount;
+    h.segmentCountLength = _segmentCountLength;
+    h.arrayLength = _arrayLength;
+    h.format = _format;
+
+    unsigned char head[FUSE_FILE_HEADER];
+    uint16_t size = sizeof(FUSE_HEADER);
+    memset(head, 0, sizeof(head));
+    memcpy(head, FUSE_MAGIC, strlen(FUSE_MAGIC));
+    memcpy(head + 16, &size, sizeof(uint16_t));
+    memcpy(head + 24, &h, sizeof(h));
+
+    if (fwrite(head, 1, sizeof(head), f) != sizeof(head))
+        return 2;
+    if (fwrite(_fp, 1, (size_t)_bytes, f) != _bytes)
+        return 3;
+    return 0;
+}
+
+// The fingerprints are used in place, buf must stay valid for the life of the filter
+int FuseFilter::load(const unsigned char *buf, unsigned long long size)
+{
+    if (_ready)
+        return 1;
+    if (size < FUSE_FILE_HEADER || memcmp(buf, FUSE_MAGIC, strlen(FUSE_MAGIC)) != 0)
+        return 2;
+
+    uint16_t hsize;
+    memcpy(&hsize, buf + 16, sizeof(uint16_t));
+    if (hsize != sizeof(FUSE_HEADER))
+        return 3;
+
+    FUSE_HEADER h;
+    memcpy(&h, buf + 24, sizeof(h));
+    if ((h.format != FILTER_FUSE8 && h.format != FILTER_FUSE16) || size < FUSE_FILE_HEADER + h.bytes)
+        return 4;
+
+    _entries = h.entries;
+    _bytes = h.bytes;
+    _seed = h.seed;
+    _segmentLength = h.segmentLength;
+    _segmentLengthMask = h.segmentLength - 1;
+    _segmentCount = h.segmentCount;
+    _segmentCountLength = h.segmentCountLength;
+    _arrayLength = h.arrayLength;
+    _format = h.format;
+    _fp = (unsigned char *)buf + FUSE_FILE_HEADER;
+    _mapped = 1;
+    _ready = 1;
+    return 0;
+}
+
+bool FuseFilter::get_ready()
+{
+    return _ready != 0;
+}
+int FuseFilter::get_format()
+{
+    return _format;
+}
+uint64_t FuseFilter::get_seed()
+{
+    return _seed;
+}
+uint32_t FuseFilter::get_segment_length()
+{
+    return _segmentLength;
+}
+uint32_t FuseFilter::get_segment_count_length()
+{
+    return _segmentCountLength;
+}
+unsigned long long int FuseFilter::get_bytes()
+{
+    return _bytes;
+}
+const unsigned char *FuseFilter::get_fp()
+{
+    return _fp;
+}
+
+// murmur3 64 bits finalizer
+uint64_t FuseFilter::mix(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t FuseFilter::splitmix64(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t FuseFilter::mulhi(uint64_t a, uint64_t b)
+{
+#ifdef WIN64
+    return __umulh(a, b);
+#else
+    return (uint64_t)(((unsigned __int128)a * b) >> 64);
+#endif
+}
+
+// Slot of the key hash in the segment index (0, 1 or 2)
+uint32_t FuseFilter::position(int index, uint64_t hash)
+{
+    uint64_t h = mulhi(hash, _segmentCountLength);
+    h += (uint64_t)index * _segmentLength;
+    uint64_t hh = hash & ((1ULL << 36) - 1);
+    h ^= (hh >> (36 - 18 * index)) & _segmentLengthMask;
+    return (uint32_t)h;
+}
+
+// Peeling construction, retried with a new seed until the 3-hypergraph is
+// acyclic (a few attempts at most). Keys must be distinct.
+bool FuseFilter::populate(const uint64_t *keys, uint32_t size)
+{
+    uint32_t capacity = _arrayLength;
+    uint64_t rng = 0x726b2b9d438b9d4dULL;
+    _seed = splitmix64(&rng);
+
+    uint64_t *reverseOrder = (uint64_t *)calloc((size_t)size + 1, sizeof(uint64_t));
+    uint32_t *alone = (uint32_t *)malloc((size_t)capacity * sizeof(uint32_t));
+    uint8_t *t2count = (uint8_t *)calloc(capacity, 1);
+    uint8_t *reverseH = (uint8_t *)malloc(size);
+    uint64_t *t2hash = (uint64_t *)calloc(capacity, sizeof(uint64_t));
+
+    uint32_t blockBits = 1;
+    while (((uint32_t)1 << blockBits) < _segmentCount)
+        blockBits++;
+    uint32_t block = 1U << blockBits;
+    uint32_t *startPos = (uint32_t *)malloc(block * sizeof(uint32_t));
+
+    if (!reverseOrder || !alone || !t2count || !reverseH || !t2hash || !startPos) {
+        free(reverseOrder); free(alone); free(t2count); free(reverseH); free(t2hash); free(startPos);
+        return false;
+    }
+
+    uint32_t h012[5];
+    bool ok = false;
+    reverseOrder[size] = 1;
+
+    for (int loop = 0; loop < FUSE_MAX_ITERATIONS; loop++) {
+
+        // Order the key hashes by segment to keep the counters cache friendly
+        for (uint32_t i = 0; i < block; i++)
+            startPos[i] = (uint32_t)(((uint64_t)i * size) >> blockBits);
+        uint32_t maskBlock = block - 1;
+        for (uint32_t i = 0; i < size; i++) {
+            uint64_t hash = mix(keys[i] + _seed);
+            uint64_t segmentIndex = hash >> (64 - blockBits);
+            while (reverseOrder[startPos[segmentIndex]] != 0) {
+                segmentIndex++;
+                segmentIndex &= maskBlock;
+            }
+            reverseOrder[startPos[segmentIndex]] = hash;
+            startPos[segmentIndex]++;
+        }
+
+        int error = 0;
+        for (uint32_t i = 0; i < size; i++) {
+            uint64_t hash = reverseOrder[i];
+            uint32_t h0 = position(0, hash);
+            uint32_t h1 = position(1, hash);
+            uint32_t h2 = position(2, hash);
+            t2count[h0] += 4;
+            t2hash[h0] ^= hash;
+            t2count[h1] += 4;
+            t2count[h1] ^= 1;
+            t2hash[h1] ^= hash;
+            t2count[h2] += 4;
+            t2count[h2] ^= 2;
+            t2hash[h2] ^= hash;
+            // 8 bits counters overflow (more than 63 keys on a slot)
+            if (t2count[h0] < 4 || t2count[h1] < 4 || t2count[h2] < 4)
+                error = 1;
+        }
+
+        if (!error) {
+
+            // Peel the slots holding a single key
+            uint32_t qSize = 0;
+            for (uint32_t i = 0; i < capacity; i++) {
+                alone[qSize] = i;
+                qSize += ((t2count[i] >> 2) == 1) ? 1 : 0;
+            }
+            uint32_t stackSize = 0;
+            while (qSize > 0) {
+                qSize--;
+                uint32_t index = alone[qSize];
+                if ((t2count[index] >> 2) == 1) {
+                    uint64_t hash = t2hash[index];
+                    h012[0] = position(0, hash);
+                    h012[1] = position(1, hash);
+                    h012[2] = position(2, hash);
+                    h012[3] = h012[0];
+                    h012[4] = h012[1];
+                    uint8_t found = t2count[index] & 3;
+                    reverseH[stackSize] = found;
+                    reverseOrder[stackSize] = hash;
+                    stackSize++;
+
+                    uint32_t other1 = h012[found + 1];
+                    alone[qSize] = other1;
+                    qSize += ((t2count[other1] >> 2) == 2) ? 1 : 0;
+                    t2count[other1] -= 4;
+                    t2count[other1] ^= (found + 1) % 3;
+                    t2hash[other1] ^= hash;
+
+                    uint32_t other2 = h012[found + 2];
+                    alone[qSize] = other2;
+                    qSize += ((t2count[other2] >> 2) == 2) ? 1 : 0;
+                    t2count[other2] -= 4;
+                    t2count[other2] ^= (found + 2) % 3;
+                    t2hash[other2] ^= hash;
+                }
+            }
+
+            if (stackSize == size) {
+                ok = true;
+                break;
+            }
+
+        }
+
+        memset(reverseOrder, 0, sizeof(uint64_t) * size);
+        memset(t2count, 0, capacity);
+        memset(t2hash, 0, sizeof(uint64_t) * capacity);
+        _seed = splitmix64(&rng);
+
+    }
+
+    if (ok) {
+        // Assign the fingerprints in reverse peeling order
+        for (uint32_t i = size - 1; i < size; i--) {
+            uint64_t hash = reverseOrder[i];
+            uint8_t found = reverseH[i];
+            h012[0] = position(0, hash);
+            h012[1] = position(1, hash);
+            h012[2] = position(2, hash);
+            h012[3] = h012[0];
+            h012[4] = h012[1];
+            if (_format == FILTER_FUSE16) {
+                uint16_t *fp = (uint16_t *)_fp;
+                fp[h012[found]] = (uint16_t)(hash ^ (hash >> 32)) ^ fp[h012[found + 1]] ^ fp[h012[found + 2]];
+            } else {
+                _fp[h012[found]] = (uint8_t)(hash ^ (hash >> 32)) ^ _fp[h012[found + 1]] ^ _fp[h012[found + 2]];
+            }
+        }
+    }
+
+    free(reverseOrder);
+    free(alone);
+    free(t2count);
+    free(reverseH);
+    free(t2hash);
+    free(startPos);
+
+    return ok;
+}
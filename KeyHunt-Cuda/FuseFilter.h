@@ -0,0 +1,62 @@
+#ifndef FUSEFILTER_H
+#define FUSEFILTER_H
+
+#include <stdint.h>
+#include "Bloom.h"
+
+// Filter formats following the Bloom layouts (see Bloom.h), one format word
+// describes the target filter to the CPU and GPU query paths
+#define FILTER_FUSE8  2   // binary fuse filter, 8 bits fingerprints
+#define FILTER_FUSE16 3   // binary fuse filter, 16 bits fingerprints
+
+// Saved filter: magic, header and parameters, then the fingerprints
+#define FUSE_MAGIC "fuse1"
+#define FUSE_FILE_HEADER 128
+
+// Static 3-wise binary fuse filter (Graf & Lemire), built once from the sorted
+// target array. The 64 bits key is the first 8 bytes of the target which is
+// already a hash; a query xors 3 fingerprints lying in 3 consecutive segments.
+class FuseFilter
+{
+public:
+    FuseFilter(const uint8_t *data, uint64_t count, int len, int format);
+    FuseFilter();   // empty, see load()
+    ~FuseFilter();
+    int check(const void *buffer, int len);
+    void prefetch(const void *buffer, int len);
+    void print();
+    int save(FILE *f);
+    int load(const unsigned char *buf, unsigned long long int size);
+
+    bool get_ready();   // false when the construction failed
+    int get_format();
+    uint64_t get_seed();
+    uint32_t get_segment_length();
+    uint32_t get_segment_count_length();
+    unsigned long long int get_bytes();
+    const unsigned char *get_fp();
+
+private:
+    static uint64_t mix(uint64_t h);
+    static uint64_t splitmix64(uint64_t *state);
+    static uint64_t mulhi(uint64_t a, uint64_t b);
+    uint32_t position(int index, uint64_t hash);
+    uint64_t positions(const void *buffer, uint32_t *h);
+    bool populate(const uint64_t *keys, uint32_t size);
+
+private:
+    int _format;
+    unsigned long long int _entries;
+    uint64_t _seed;
+    uint32_t _segmentLength;
+    uint32_t _segmentLengthMask;
+    uint32_t _segmentCount;
+    uint32_t _segmentCountLength;
+    uint32_t _arrayLength;
+    unsigned long long int _bytes;
+    unsigned char *_fp;
+    unsigned char _ready;
+    unsigned char _mapped;      // _fp points in a loaded buffer, not owned
+};
+
+#endif // FUSEFILTER_H
@@ -18,9 +18,9 @@
 #include <device_atomic_functions.h>
 #include <device_functions.h>
 
-__device__ int test_bit_set_bit(const uint8_t* buf, uint32_t bit)
+__device__ int test_bit_set_bit(const uint8_t* buf, uint64_t bit)
 {
-	uint32_t byte = bit >> 3;
+	uint64_t byte = bit >> 3;
 	uint8_t c = buf[byte];        // expensive memory access
 	uint8_t mask = 1 << (bit % 8);
 
@@ -63,16 +63,101 @@ __device__ uint32_t murmurhash2(const void* key, int len, uint32_t seed)
 	return h;
 }
 
-__device__ int BloomCheck(const uint32_t* hash, const uint8_t* inputBloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES)
+// Bloom layout (BLOOM_CLASSIC or BLOOM_BLOCKED) or-ed with the probe derivation, or fuse filter format
+__device__ __constant__ int _bloomFormat = BLOOM_CLASSIC | BLOOM_DIRECT;
+__device__ __constant__ uint32_t _bloomSalt[BLOOM_BLOCK_WORDS] = BLOOM_SALTS;
+
+// First level filter (see PreFilter), disabled while the shift is 32
+__device__ __constant__ const uint8_t* _preFilter;
+__device__ __constant__ int _preFilterShift = 32;
+
+// Blocked layout: a single 64 bytes block holds one bit per 32 bits word
+__device__ int BloomCheckBlocked(uint64_t a, uint32_t b, const uint8_t* inputBloomLookUp, uint64_t BLOOM_BITS)
+{
+	uint64_t blocks = BLOOM_BITS / BLOOM_BLOCK_BITS;
+	const uint4* blk = (const uint4*)(inputBloomLookUp + __umul64hi(a, blocks) * 64);
+	uint32_t miss = 0;
+
+#pragma unroll
+	for (int i = 0; i < 4; i++) {
+		uint4 w = blk[i];
+		uint32_t m0 = 1U << ((b * _bloomSalt[4 * i + 0]) >> 27);
+		uint32_t m1 = 1U << ((b * _bloomSalt[4 * i + 1]) >> 27);
+		uint32_t m2 = 1U << ((b * _bloomSalt[4 * i + 2]) >> 27);
+		uint32_t m3 = 1U << ((b * _bloomSalt[4 * i + 3]) >> 27);
+		miss |= (m0 & ~w.x) | (m1 & ~w.y) | (m2 & ~w.z) | (m3 & ~w.w);
+	}
+
+	return miss == 0;
+}
+
+// Binary fuse filter parameters (see FuseFilter), the lookup buffer holds the fingerprints
+__device__ __constant__ uint64_t _fuseSeed;
+__device__ __constant__ uint32_t _fuseSegmentLength;
+__device__ __constant__ uint32_t _fuseSegmentCountLength;
+
+__device__ int FuseCheck(const uint32_t* hash, const uint8_t* inputFingerprints)
+{
+	uint64_t h = (((uint64_t)hash[1] << 32) | hash[0]) + _fuseSeed;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+
+	uint32_t h0 = (uint32_t)__umul64hi(h, _fuseSegmentCountLength);
+	uint32_t h1 = h0 + _fuseSegmentLength;
+	uint32_t h2 = h1 + _fuseSegmentLength;
+	uint32_t mask = _fuseSegmentLength - 1;
+	h1 ^= (uint32_t)(h >> 18) & mask;
+	h2 ^= (uint32_t)h & mask;
+
+	uint32_t f = (uint32_t)(h ^ (h >> 32));
+	if (BLOOM_LAYOUT(_bloomFormat) == FILTER_FUSE16) {
+		const uint16_t* fp = (const uint16_t*)inputFingerprints;
+		return ((f ^ fp[h0] ^ fp[h1] ^ fp[h2]) & 0xFFFF) == 0;
+	}
+	return ((f ^ inputFingerprints[h0] ^ inputFingerprints[h1] ^ inputFingerprints[h2]) & 0xFF) == 0;
+}
+
+__device__ int BloomCheck(const uint32_t* hash, const uint8_t* inputBloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES,
+	int len = 20)
 {
+	if (_preFilterShift < 32) {
+		uint32_t w = hash[PREFILTER_OFFSET / 4] >> _preFilterShift;
+		if (((_preFilter[w >> 3] >> (w & 7)) & 1) == 0)
+			return 0;
+	}
+
+	if (BLOOM_LAYOUT(_bloomFormat) >= FILTER_FUSE8)
+		return FuseCheck(hash, inputBloomLookUp);
+
+	// 64 bits probes, see Bloom::probes()
+	uint64_t a, b;
+	if (_bloomFormat & BLOOM_DIRECT) {
+		a = ((uint64_t)hash[1] << 32) | hash[0];
+		b = ((uint64_t)hash[3] << 32) | hash[2];
+	}
+	else {
+		uint32_t h1 = murmurhash2((uint8_t*)hash, len, 0x9747b28c);
+		uint32_t h2 = murmurhash2((uint8_t*)hash, len, h1);
+		a = ((uint64_t)h2 << 32) | h1;
+		b = a ^ (a >> 33);
+		b *= 0xff51afd7ed558ccdULL;
+		b ^= b >> 33;
+		b *= 0xc4ceb9fe1a85ec53ULL;
+		b ^= b >> 33;
+	}
+
+	if (BLOOM_LAYOUT(_bloomFormat) == BLOOM_BLOCKED)
+		return BloomCheckBlocked(a, (uint32_t)b, inputBloomLookUp, BLOOM_BITS);
+
 	int add = 0;
 	uint8_t hits = 0;
-	uint32_t a = murmurhash2((uint8_t*)hash, 20, 0x9747b28c);
-	uint32_t b = murmurhash2((uint8_t*)hash, 20, a);
-	uint32_t x;
+	uint64_t x;
 	uint8_t i;
 	for (i = 0; i < BLOOM_HASHES; i++) {
-		x = (a + b * i) % BLOOM_BITS;
+		x = __umul64hi(a + b * i, BLOOM_BITS);
 		if (test_bit_set_bit(inputBloomLookUp, x)) {
 			hits++;
 		}
@@ -92,55 +177,90 @@ __device__ __noinline__ void ClearCouter(uint32_t* out)
 	uint32_t pos = atomicAnd(out, 0);
 }
 
-__device__ __noinline__ void CheckPoint(uint32_t* _h, int32_t incr, int32_t endo, int32_t mode,
-	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out, int type)
+// Segwit mode: also check the P2SH-P2WPKH script hash of compressed keys
+__device__ __constant__ uint32_t _segwit = 0;
+
+__device__ __forceinline__ void OutputItem(uint32_t* _h, int32_t incr, int32_t endo, int32_t mode, int type,
+	uint32_t maxFound, uint32_t* out)
 {
 	uint32_t tid = (blockIdx.x * blockDim.x) + threadIdx.x;
-
-	if (BloomCheck(_h, bloomLookUp, BLOOM_BITS, BLOOM_HASHES) > 0) {
-		uint32_t pos = atomicAdd(out, 1);
-		if (pos < maxFound) {
-			out[pos * ITEM_SIZE32 + 1] = tid;
-			out[pos * ITEM_SIZE32 + 2] = (uint32_t)(incr << 16) | (uint32_t)(mode << 15) | (uint32_t)(endo);
-			out[pos * ITEM_SIZE32 + 3] = _h[0];
-			out[pos * ITEM_SIZE32 + 4] = _h[1];
-			out[pos * ITEM_SIZE32 + 5] = _h[2];
-			out[pos * ITEM_SIZE32 + 6] = _h[3];
-			out[pos * ITEM_SIZE32 + 7] = _h[4];
+	uint32_t pos = atomicAdd(out, 1);
+	if (pos < maxFound) {
+		out[pos * ITEM_SIZE32 + 1] = tid;
+		out[pos * ITEM_SIZE32 + 2] = (uint32_t)(incr << 16) | (uint32_t)(mode << 15) | (uint32_t)(type << 8) | (uint32_t)(endo);
+		out[pos * ITEM_SIZE32 + 3] = _h[0];
+		out[pos * ITEM_SIZE32 + 4] = _h[1];
+		out[pos * ITEM_SIZE32 + 5] = _h[2];
+		out[pos * ITEM_SIZE32 + 6] = _h[3];
+		out[pos * ITEM_SIZE32 + 7] = _h[4];
+		if (type == XPOINT) {
+			out[pos * ITEM_SIZE32 + 8] = _h[5];
+			out[pos * ITEM_SIZE32 + 9] = _h[6];
+			out[pos * ITEM_SIZE32 + 10] = _h[7];
 		}
 	}
 }
 
-__device__ __noinline__ bool MatchHash160(uint32_t* _h, uint32_t* hash160)
+__device__ __noinline__ void CheckPoint(uint32_t* _h, int32_t incr, int32_t endo, int32_t mode,
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out, int type)
 {
-	if (_h[0] == hash160[0] &&
-		_h[1] == hash160[1] &&
-		_h[2] == hash160[2] &&
-		_h[3] == hash160[3] &&
-		_h[4] == hash160[4]) {
-		return true;
+	if (BloomCheck(_h, bloomLookUp, BLOOM_BITS, BLOOM_HASHES) > 0)
+		OutputItem(_h, incr, endo, mode, type, maxFound, out);
+
+	if (_segwit && mode) {
+		uint32_t hs[5];
+		_GetHash160Script(_h, (uint8_t*)hs);
+		if (BloomCheck(hs, bloomLookUp, BLOOM_BITS, BLOOM_HASHES) > 0)
+			OutputItem(hs, incr, endo, mode, P2SH, maxFound, out);
 	}
-	else {
+}
+
+// Target set of the single address mode, the fences stay in constant memory
+__device__ __constant__ uint32_t _setFence[SET_MAX_BLOCKS];
+__device__ __constant__ uint32_t _setBlocks;
+__device__ __constant__ uint32_t _setCount;
+
+// Target set lookup (see TargetSet), set holds the padded prefixes then the
+// records. The scan of the fences is uniform over the warp and served by the
+// constant cache, only the prefixes of one block are read from global memory.
+__device__ __noinline__ bool MatchSet(uint32_t* _h, uint32_t* set, uint32_t nWords)
+{
+	uint32_t b = 0;
+	for (uint32_t i = 0; i < _setBlocks; i++)
+		b += (_setFence[i] < _h[0]) ? 1 : 0;
+	if (b >= _setBlocks)
 		return false;
+
+	uint32_t* records = set + _setBlocks * SET_BLOCK;
+	for (uint32_t i = b * SET_BLOCK; i < _setCount && set[i] <= _h[0]; i++) {
+		if (set[i] == _h[0]) {
+			uint32_t* r = records + i * nWords;
+			bool match = true;
+			for (uint32_t j = 1; j < nWords; j++)
+				match &= (_h[j] == r[j]);
+			if (match)
+				return true;
+		}
 	}
+	return false;
+}
+
+__device__ __noinline__ bool MatchHash160(uint32_t* _h, uint32_t* hash160)
+{
+	return MatchSet(_h, hash160, 5);
 }
 
 __device__ __noinline__ void CheckPoint2(uint32_t* _h, int32_t incr, int32_t endo, int32_t mode,
 	uint32_t* hash160, uint32_t maxFound, uint32_t* out, int type)
 {
-	uint32_t tid = (blockIdx.x * blockDim.x) + threadIdx.x;
-
-	if (MatchHash160(_h, hash160)) {
-		uint32_t pos = atomicAdd(out, 1);
-		if (pos < maxFound) {
-			out[pos * ITEM_SIZE32 + 1] = tid;
-			out[pos * ITEM_SIZE32 + 2] = (uint32_t)(incr << 16) | (uint32_t)(mode << 15) | (uint32_t)(endo);
-			out[pos * ITEM_SIZE32 + 3] = _h[0];
-			out[pos * ITEM_SIZE32 + 4] = _h[1];
-			out[pos * ITEM_SIZE32 + 5] = _h[2];
-			out[pos * ITEM_SIZE32 + 6] = _h[3];
-			out[pos * ITEM_SIZE32 + 7] = _h[4];
-		}
+	if (MatchHash160(_h, hash160))
+		OutputItem(_h, incr, endo, mode, type, maxFound, out);
+
+	if (_segwit && mode) {
+		uint32_t hs[5];
+		_GetHash160Script(_h, (uint8_t*)hs);
+		if (MatchHash160(hs, hash160))
+			OutputItem(hs, incr, endo, mode, P2SH, maxFound, out);
 	}
 }
 
@@ -149,7 +269,7 @@ __device__ __noinline__ void CheckPoint2(uint32_t* _h, int32_t incr, int32_t end
 #define CHECK_POINT(_h,incr,endo,mode)  CheckPoint(_h,incr,endo,mode,bloomLookUp,BLOOM_BITS,BLOOM_HASHES,maxFound,out,P2PKH)
 
 __device__ __noinline__ void CheckHashComp(uint64_t* px, uint8_t isOdd, int32_t incr,
-	uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
 {
 
 	uint32_t   h[5];
@@ -207,7 +327,7 @@ __device__ __noinline__ void CheckHashComp2(uint64_t* px, uint8_t isOdd, int32_t
 // -----------------------------------------------------------------------------------------
 
 __device__ __noinline__ void CheckHashUncomp(uint64_t* px, uint64_t* py, int32_t incr,
-	uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
 {
 
 	uint32_t   h[5];
@@ -264,10 +384,76 @@ __device__ __noinline__ void CheckHashUncomp2(uint64_t* px, uint64_t* py, int32_
 
 }
 
+// -----------------------------------------------------------------------------------------
+// x point search (XPOINT): x is checked directly, a point and its symetric share x
+
+__device__ __forceinline__ void _GetXPoint(uint64_t* px, uint32_t* x)
+{
+	// Big endian bytes of x, as in the target file
+	uint32_t* x32 = (uint32_t*)(px);
+	x[0] = bswap32(x32[7]);
+	x[1] = bswap32(x32[6]);
+	x[2] = bswap32(x32[5]);
+	x[3] = bswap32(x32[4]);
+	x[4] = bswap32(x32[3]);
+	x[5] = bswap32(x32[2]);
+	x[6] = bswap32(x32[1]);
+	x[7] = bswap32(x32[0]);
+}
+
+__device__ __noinline__ void CheckHashX(uint64_t* px, int32_t incr,
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+{
+
+	uint32_t   x[8];
+	uint64_t   pe1x[4];
+	uint64_t   pe2x[4];
+
+	_GetXPoint(px, x);
+	if (BloomCheck(x, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, 32) > 0)
+		OutputItem(x, incr, 0, true, XPOINT, maxFound, out);
+	_ModMult(pe1x, px, _beta);
+	_GetXPoint(pe1x, x);
+	if (BloomCheck(x, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, 32) > 0)
+		OutputItem(x, incr, 1, true, XPOINT, maxFound, out);
+	_ModMult(pe2x, px, _beta2);
+	_GetXPoint(pe2x, x);
+	if (BloomCheck(x, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, 32) > 0)
+		OutputItem(x, incr, 2, true, XPOINT, maxFound, out);
+
+}
+
+__device__ __forceinline__ bool MatchXPoint(uint32_t* _x, uint32_t* xpoint)
+{
+	return MatchSet(_x, xpoint, 8);
+}
+
+__device__ __noinline__ void CheckHashX2(uint64_t* px, int32_t incr,
+	uint32_t* xpoint, uint32_t maxFound, uint32_t* out)
+{
+
+	uint32_t   x[8];
+	uint64_t   pe1x[4];
+	uint64_t   pe2x[4];
+
+	_GetXPoint(px, x);
+	if (MatchXPoint(x, xpoint))
+		OutputItem(x, incr, 0, true, XPOINT, maxFound, out);
+	_ModMult(pe1x, px, _beta);
+	_GetXPoint(pe1x, x);
+	if (MatchXPoint(x, xpoint))
+		OutputItem(x, incr, 1, true, XPOINT, maxFound, out);
+	_ModMult(pe2x, px, _beta2);
+	_GetXPoint(pe2x, x);
+	if (MatchXPoint(x, xpoint))
+		OutputItem(x, incr, 2, true, XPOINT, maxFound, out);
+
+}
+
 // -----------------------------------------------------------------------------------------
 
 __device__ __noinline__ void CheckHash(uint32_t mode, uint64_t* px, uint64_t* py, int32_t incr,
-	uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
 {
 
 	switch (mode) {
@@ -281,6 +467,9 @@ __device__ __noinline__ void CheckHash(uint32_t mode, uint64_t* px, uint64_t* py
 		CheckHashComp(px, (uint8_t)(py[0] & 1), incr, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, maxFound, out);
 		CheckHashUncomp(px, py, incr, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, maxFound, out);
 		break;
+	case SEARCH_XPOINT:
+		CheckHashX(px, incr, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, maxFound, out);
+		break;
 	}
 
 }
@@ -291,7 +480,7 @@ __device__ __noinline__ void CheckHash(uint32_t mode, uint64_t* px, uint64_t* py
 // -----------------------------------------------------------------------------------------
 
 __device__ void ComputeKeys(uint32_t mode, uint64_t* startx, uint64_t* starty,
-	uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+	uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
 {
 
 	uint64_t dx[GRP_SIZE / 2 + 1][4];
@@ -435,6 +624,9 @@ __device__ __noinline__ void CheckHash2(uint32_t mode, uint64_t* px, uint64_t* p
 		CheckHashComp2(px, (uint8_t)(py[0] & 1), incr, hash160, maxFound, out);
 		CheckHashUncomp2(px, py, incr, hash160, maxFound, out);
 		break;
+	case SEARCH_XPOINT:
+		CheckHashX2(px, incr, hash160, maxFound, out);
+		break;
 	}
 
 }
@@ -585,7 +777,7 @@ CheckPoint(h2, -(_incr), 2, true, bloomLookUp, BLOOM_BITS, BLOOM_HASHES, maxFoun
 }
 
 __device__ void ComputeKeysComp(uint64_t* startx, uint64_t* starty, uint8_t* bloomLookUp,
-	int BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
+	uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint32_t maxFound, uint32_t* out)
 {
 
 	uint64_t dx[GRP_SIZE / 2 + 1][4];
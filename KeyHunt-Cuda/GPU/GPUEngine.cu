@@ -24,6 +24,11 @@
 #include "../hash/sha256.h"
 #include "../hash/ripemd160.h"
 #include "../Timer.h"
+#include "../Bloom.h"
+#include "../FuseFilter.h"
+#include "../TargetIndex.h"
+#include "../PreFilter.h"
+#include "../TargetSet.h"
 
 #include "GPUGroup.h"
 #include "GPUMath.h"
@@ -47,7 +52,7 @@ inline void __cudaSafeCall(cudaError err, const char* file, const int line)
 // ---------------------------------------------------------------------------------------
 
 // mode address file
-__global__ void comp_keys(uint32_t mode, uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES,
+__global__ void comp_keys(uint32_t mode, uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES,
 	uint64_t* keys, uint32_t maxFound, uint32_t* found)
 {
 
@@ -57,7 +62,7 @@ __global__ void comp_keys(uint32_t mode, uint8_t* bloomLookUp, int BLOOM_BITS, u
 
 }
 
-__global__ void comp_keys_comp(uint8_t* bloomLookUp, int BLOOM_BITS, uint8_t BLOOM_HASHES, uint64_t* keys,
+__global__ void comp_keys_comp(uint8_t* bloomLookUp, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, uint64_t* keys,
 	uint32_t maxFound, uint32_t* found)
 {
 
@@ -140,8 +145,8 @@ int _ConvertSMVer2Cores(int major, int minor)
 }
 
 GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_t maxFound, /*bool rekey,*/
-	int64_t BLOOM_SIZE, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, const uint8_t* BLOOM_DATA,
-	uint8_t* DATA, uint64_t TOTAL_ADDR)
+	int64_t BLOOM_SIZE, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, int BLOOM_FORMAT, const uint8_t* BLOOM_DATA,
+	const TargetIndex* index, uint32_t DATA_LEN)
 {
 
 	// Initialise CUDA
@@ -151,11 +156,19 @@ GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_
 	this->BLOOM_SIZE = BLOOM_SIZE;
 	this->BLOOM_BITS = BLOOM_BITS;
 	this->BLOOM_HASHES = BLOOM_HASHES;
-	this->DATA = DATA;
-	this->TOTAL_ADDR = TOTAL_ADDR;
+	this->BLOOM_FORMAT = BLOOM_FORMAT;
+	this->index = index;
+	this->DATA_LEN = DATA_LEN;
+	this->inputPreFilter = NULL;
 
 	initialised = false;
 
+	// The kernels test the same layout and probe derivation as the host filter
+	if ((BLOOM_FORMAT & ~(BLOOM_DIRECT | 0x0F)) != 0 || BLOOM_LAYOUT(BLOOM_FORMAT) > FILTER_FUSE16) {
+		printf("GPUEngine: Unsupported Bloom format 0x%X\n", BLOOM_FORMAT);
+		return;
+	}
+
 	int deviceCount = 0;
 	CudaSafeCall(cudaGetDeviceCount(&deviceCount));
 
@@ -207,6 +220,7 @@ GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_
 	memcpy(inputBloomLookUpPinned, BLOOM_DATA, BLOOM_SIZE);
 
 	CudaSafeCall(cudaMemcpy(inputBloomLookUp, inputBloomLookUpPinned, BLOOM_SIZE, cudaMemcpyHostToDevice));
+	CudaSafeCall(cudaMemcpyToSymbol(_bloomFormat, &BLOOM_FORMAT, sizeof(int)));
 	CudaSafeCall(cudaFreeHost(inputBloomLookUpPinned));
 	inputBloomLookUpPinned = NULL;
 
@@ -218,7 +232,7 @@ GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_
 
 }
 
-GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_t maxFound, uint32_t* hash160)
+GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_t maxFound, TargetSet* set)
 {
 
 	// Initialise CUDA
@@ -269,15 +283,28 @@ GPUEngine::GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_
 	CudaSafeCall(cudaMalloc((void**)&outputBuffer, outputSize));
 	CudaSafeCall(cudaHostAlloc(&outputBufferPinned, outputSize, cudaHostAllocWriteCombined | cudaHostAllocMapped));
 
-	CudaSafeCall(cudaMalloc((void**)&inputHash160, 5 * sizeof(uint32_t)));
-	CudaSafeCall(cudaHostAlloc(&inputHash160Pinned, 5 * sizeof(uint32_t), cudaHostAllocWriteCombined | cudaHostAllocMapped));
-
-	memcpy(inputHash160Pinned, hash160, 5 * sizeof(uint32_t));
-
-	CudaSafeCall(cudaMemcpy(inputHash160, inputHash160Pinned, 5 * sizeof(uint32_t), cudaMemcpyHostToDevice));
+	// Target set of hash160 or x point (XPOINT): padded prefixes then records,
+	// the fences go to constant memory
+	this->DATA_LEN = set->get_len();
+	this->inputPreFilter = NULL;
+	uint32_t blocks = set->get_blocks();
+	uint32_t count = set->get_count();
+	size_t prefixSize = blocks * SET_BLOCK * sizeof(uint32_t);
+	size_t setSize = prefixSize + count * DATA_LEN;
+	CudaSafeCall(cudaMalloc((void**)&inputHash160, setSize));
+	CudaSafeCall(cudaHostAlloc(&inputHash160Pinned, setSize, cudaHostAllocWriteCombined | cudaHostAllocMapped));
+
+	memcpy(inputHash160Pinned, set->get_prefixes(), prefixSize);
+	memcpy((uint8_t*)inputHash160Pinned + prefixSize, set->get_records(), count * DATA_LEN);
+
+	CudaSafeCall(cudaMemcpy(inputHash160, inputHash160Pinned, setSize, cudaMemcpyHostToDevice));
 	CudaSafeCall(cudaFreeHost(inputHash160Pinned));
 	inputHash160Pinned = NULL;
 
+	CudaSafeCall(cudaMemcpyToSymbol(_setFence, set->get_fences(), blocks * sizeof(uint32_t)));
+	CudaSafeCall(cudaMemcpyToSymbol(_setBlocks, &blocks, sizeof(uint32_t)));
+	CudaSafeCall(cudaMemcpyToSymbol(_setCount, &count, sizeof(uint32_t)));
+
 	CudaSafeCall(cudaGetLastError());
 
 	searchMode = SEARCH_COMPRESSED;
@@ -330,6 +357,8 @@ GPUEngine::~GPUEngine()
 		CudaSafeCall(cudaFree(inputBloomLookUp));
 	else
 		CudaSafeCall(cudaFree(inputHash160));
+	if (inputPreFilter)
+		CudaSafeCall(cudaFree(inputPreFilter));
 	CudaSafeCall(cudaFreeHost(outputBufferPinned));
 	CudaSafeCall(cudaFree(outputBuffer));
 }
@@ -349,6 +378,50 @@ void GPUEngine::SetSearchType(int searchType)
 	this->searchType = searchType;
 }
 
+void GPUEngine::SetSegwit(bool segwit)
+{
+	uint32_t s = segwit ? 1 : 0;
+	CudaSafeCall(cudaMemcpyToSymbol(_segwit, &s, sizeof(uint32_t)));
+}
+
+void GPUEngine::SetFuseFilter(uint64_t seed, uint32_t segmentLength, uint32_t segmentCountLength)
+{
+	CudaSafeCall(cudaMemcpyToSymbol(_fuseSeed, &seed, sizeof(uint64_t)));
+	CudaSafeCall(cudaMemcpyToSymbol(_fuseSegmentLength, &segmentLength, sizeof(uint32_t)));
+	CudaSafeCall(cudaMemcpyToSymbol(_fuseSegmentCountLength, &segmentCountLength, sizeof(uint32_t)));
+}
+
+// The table is small enough to stay in L2, BloomCheck() probes it before the main filter
+void GPUEngine::SetPreFilter(const uint8_t* table, uint64_t bytes, int shift)
+{
+	CudaSafeCall(cudaMalloc((void**)&inputPreFilter, bytes));
+	CudaSafeCall(cudaMemcpy(inputPreFilter, table, bytes, cudaMemcpyHostToDevice));
+	CudaSafeCall(cudaMemcpyToSymbol(_preFilter, &inputPreFilter, sizeof(uint8_t*)));
+	CudaSafeCall(cudaMemcpyToSymbol(_preFilterShift, &shift, sizeof(int)));
+}
+
+// Bytes of targets added during the search, or-ed in the filter in place.
+// The kernels of the default stream run one after the other, no search
+// kernel sees a partial update.
+void GPUEngine::UpdateFilter(const uint64_t* offsets, const uint8_t* values, uint32_t n, bool preFilter)
+{
+	if (n == 0)
+		return;
+
+	uint64_t* inputOffsets;
+	uint8_t* inputValues;
+	CudaSafeCall(cudaMalloc((void**)&inputOffsets, n * sizeof(uint64_t)));
+	CudaSafeCall(cudaMalloc((void**)&inputValues, n));
+	CudaSafeCall(cudaMemcpy(inputOffsets, offsets, n * sizeof(uint64_t), cudaMemcpyHostToDevice));
+	CudaSafeCall(cudaMemcpy(inputValues, values, n, cudaMemcpyHostToDevice));
+
+	or_bytes << < (n + 255) / 256, 256 >> > (preFilter ? inputPreFilter : inputBloomLookUp, inputOffsets, inputValues, n);
+	CudaSafeCall(cudaGetLastError());
+
+	CudaSafeCall(cudaFree(inputOffsets));
+	CudaSafeCall(cudaFree(inputValues));
+}
+
 void GPUEngine::SetAddressMode(int addressMode)
 {
 	this->addressMode = addressMode;
@@ -371,6 +444,10 @@ bool GPUEngine::callKernel()
 				(searchMode, inputBloomLookUp, BLOOM_BITS, BLOOM_HASHES, inputKey, maxFound, outputBuffer);
 		}
 	}
+	else if (searchType == XPOINT) {
+		comp_keys << < nbThread / nbThreadPerGroup, nbThreadPerGroup >> >
+			(SEARCH_XPOINT, inputBloomLookUp, BLOOM_BITS, BLOOM_HASHES, inputKey, maxFound, outputBuffer);
+	}
 	else {
 		printf("GPUEngine: Wrong searchType\n");
 		return false;
@@ -402,6 +479,10 @@ bool GPUEngine::callKernel2()
 				(searchMode, inputHash160, inputKey, maxFound, outputBuffer);
 		}
 	}
+	else if (searchType == XPOINT) {
+		comp_keys2 << < nbThread / nbThreadPerGroup, nbThreadPerGroup >> >
+			(SEARCH_XPOINT, inputHash160, inputKey, maxFound, outputBuffer);
+	}
 	else {
 		printf("GPUEngine: Wrong searchType\n");
 		return false;
@@ -503,7 +584,8 @@ bool GPUEngine::Launch(std::vector<ITEM>& dataFound, bool spinWait)
 			ITEM it;
 			it.thId = itemPtr[0];
 			int16_t* ptr = (int16_t*)&(itemPtr[1]);
-			it.endo = ptr[0] & 0x7FFF;
+			it.endo = ptr[0] & 0xFF;
+			it.type = (ptr[0] >> 8) & 0x7F;
 			it.mode = (ptr[0] & 0x8000) != 0;
 			it.incr = ptr[1];
 			it.hash = (uint8_t*)(itemPtr + 2);
@@ -549,7 +631,8 @@ bool GPUEngine::Launch2(std::vector<ITEM>& dataFound, bool spinWait)
 		ITEM it;
 		it.thId = itemPtr[0];
 		int16_t* ptr = (int16_t*)&(itemPtr[1]);
-		it.endo = ptr[0] & 0x7FFF;
+		it.endo = ptr[0] & 0xFF;
+		it.type = (ptr[0] >> 8) & 0x7F;
 		it.mode = (ptr[0] & 0x8000) != 0;
 		it.incr = ptr[1];
 		it.hash = (uint8_t*)(itemPtr + 2);
@@ -559,34 +642,10 @@ bool GPUEngine::Launch2(std::vector<ITEM>& dataFound, bool spinWait)
 }
 
 
+// Without index the caller checks the hits
 int GPUEngine::CheckBinary(const uint8_t* hash)
 {
-	uint8_t* temp_read;
-	uint64_t half, min, max, current; //, current_offset
-	int64_t rcmp;
-	int32_t r = 0;
-	min = 0;
-	current = 0;
-	max = TOTAL_ADDR;
-	half = TOTAL_ADDR;
-	while (!r && half >= 1) {
-		half = (max - min) / 2;
-		temp_read = DATA + ((current + half) * 20);
-		rcmp = memcmp(hash, temp_read, 20);
-		if (rcmp == 0) {
-			r = 1;  //Found!!
-		}
-		else {
-			if (rcmp < 0) { //data < temp_read
-				max = (max - half);
-			}
-			else { // data > temp_read
-				min = (min + half);
-			}
-			current = min;
-		}
-	}
-	return r;
+	return (index == NULL || index->find(hash)) ? 1 : 0;
 }
 
 
@@ -21,9 +21,13 @@
 #include <vector>
 #include "../SECP256k1.h"
 
+class TargetIndex;
+class TargetSet;
+
 #define SEARCH_COMPRESSED 0
 #define SEARCH_UNCOMPRESSED 1
 #define SEARCH_BOTH 2
+#define SEARCH_XPOINT 3   // kernel mode of the XPOINT search type, x coordinate only
 
 // address mode
 #define SINGLEMODE  0
@@ -35,7 +39,8 @@ static const char* searchModes[] = { "Compressed", "Uncompressed", "Compressed o
 #define STEP_SIZE 1024
 
 // Number of thread per block
-#define ITEM_SIZE 28
+// Found item: thread id, incr/mode/type/endo, hash160 or x point (8 words)
+#define ITEM_SIZE 40
 #define ITEM_SIZE32 (ITEM_SIZE/4)
 //#define _64K 65536
 
@@ -45,6 +50,7 @@ typedef struct {
 	int16_t  endo;
 	uint8_t* hash;
 	bool mode;
+	int type;
 } ITEM;
 
 class GPUEngine
@@ -53,16 +59,20 @@ class GPUEngine
 public:
 
 	GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_t maxFound,
-		int64_t BLOOM_SIZE, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, const uint8_t* BLOOM_DATA,
-		uint8_t* DATA, uint64_t TOTAL_ADDR);
+		int64_t BLOOM_SIZE, uint64_t BLOOM_BITS, uint8_t BLOOM_HASHES, int BLOOM_FORMAT, const uint8_t* BLOOM_DATA,
+		const TargetIndex* index, uint32_t DATA_LEN);
 
 	GPUEngine(int nbThreadGroup, int nbThreadPerGroup, int gpuId, uint32_t maxFound,
-		uint32_t* hash160);
+		TargetSet* set);
 
 	~GPUEngine();
 	bool SetKeys(Point* p);
 	void SetSearchMode(int searchMode);
 	void SetSearchType(int searchType);
+	void SetSegwit(bool segwit);
+	void SetFuseFilter(uint64_t seed, uint32_t segmentLength, uint32_t segmentCountLength);
+	void SetPreFilter(const uint8_t* table, uint64_t bytes, int shift);
+	void UpdateFilter(const uint64_t* offsets, const uint8_t* values, uint32_t n, bool preFilter);
 	void SetAddressMode(int addressMode);
 
 	bool Launch(std::vector<ITEM>& dataFound, bool spinWait = false);
@@ -95,6 +105,7 @@ private:
 	//uint8_t *bloomLookUp;
 	uint8_t* inputBloomLookUp;
 	uint8_t* inputBloomLookUpPinned;
+	uint8_t* inputPreFilter;
 
 	uint64_t* inputKey;
 	uint64_t* inputKeyPinned;
@@ -115,9 +126,10 @@ private:
 	int64_t BLOOM_SIZE;
 	uint64_t BLOOM_BITS;
 	uint8_t BLOOM_HASHES;
+	int BLOOM_FORMAT;
 
-	uint8_t* DATA;
-	uint64_t TOTAL_ADDR;
+	const TargetIndex* index;
+	uint32_t DATA_LEN;
 
 };
 
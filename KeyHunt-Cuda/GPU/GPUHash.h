@@ -166,6 +166,13 @@ __device__ __forceinline__ uint32_t s1(uint32_t x)
     d += t1; \
     h = t1 + t2;
 
+// SHA-256 inner round with a constant message word, k = K[i] + w[i]
+#define S2RoundK(a, b, c, d, e, f, g, h, k) \
+    t1 = h + S1(e) + Ch(e,f,g) + k; \
+    t2 = S0(a) + Maj(a,b,c); \
+    d += t1; \
+    h = t1 + t2;
+
 // WMIX
 #define WMIX() { \
 w[0] += s1(w[14]) + w[9] + s0(w[1]);\
@@ -186,6 +193,45 @@ w[14] += s1(w[12]) + w[7] + s0(w[15]);\
 w[15] += s1(w[13]) + w[8] + s0(w[0]);\
 }
 
+// First WMIX of a 33 byte message, w[9..14] = 0 and w[15] = 0x108
+#define WMIX33() { \
+w[0] += s0(w[1]);\
+w[1] += 0x00A50000 + s0(w[2]);\
+w[2] += s1(w[0]) + s0(w[3]);\
+w[3] += s1(w[1]) + s0(w[4]);\
+w[4] += s1(w[2]) + s0(w[5]);\
+w[5] += s1(w[3]) + s0(w[6]);\
+w[6] += s1(w[4]) + 0x108 + s0(w[7]);\
+w[7] += s1(w[5]) + w[0] + s0(w[8]);\
+w[8] += s1(w[6]) + w[1];\
+w[9] = s1(w[7]) + w[2];\
+w[10] = s1(w[8]) + w[3];\
+w[11] = s1(w[9]) + w[4];\
+w[12] = s1(w[10]) + w[5];\
+w[13] = s1(w[11]) + w[6];\
+w[14] = s1(w[12]) + w[7] + 0x10420023;\
+w[15] = s1(w[13]) + w[8] + s0(w[0]) + 0x108;\
+}
+
+// First WMIX of the second block of a 65 byte message, w[1..14] = 0 and w[15] = 0x208
+#define WMIX65() { \
+w[1] = 0x01450000;\
+w[2] = s1(w[0]);\
+w[3] = 0x200051CA;\
+w[4] = s1(w[2]);\
+w[5] = 0x22D45414;\
+w[6] = s1(w[4]) + 0x208;\
+w[7] = w[0] + 0xA0802025;\
+w[8] = s1(w[6]) + 0x01450000;\
+w[9] = s1(w[7]) + w[2];\
+w[10] = s1(w[8]) + 0x200051CA;\
+w[11] = s1(w[9]) + w[4];\
+w[12] = s1(w[10]) + 0x22D45414;\
+w[13] = s1(w[11]) + w[6];\
+w[14] = s1(w[12]) + w[7] + 0x10820045;\
+w[15] = s1(w[13]) + w[8] + s0(w[0]) + 0x208;\
+}
+
 // ROUND
 #define SHA256_RND(k) {\
 S2Round(a, b, c, d, e, f, g, h, K[k], w[0]);\
@@ -254,12 +300,112 @@ __device__ void SHA256Transform(uint32_t s[8], uint32_t *w)
 
 }
 
+// SHA-256 of a padded 33 byte message (compressed key), only w[0..8] are read.
+// Rounds and message schedule terms of the constant padding words are folded.
+__device__ void SHA256Transform33(uint32_t s[8], uint32_t *w)
+{
+
+    uint32_t t1;
+    uint32_t t2;
+
+    DEF(a, 0);
+    DEF(b, 1);
+    DEF(c, 2);
+    DEF(d, 3);
+    DEF(e, 4);
+    DEF(f, 5);
+    DEF(g, 6);
+    DEF(h, 7);
+
+    S2Round(a, b, c, d, e, f, g, h, K[0], w[0]);
+    S2Round(h, a, b, c, d, e, f, g, K[1], w[1]);
+    S2Round(g, h, a, b, c, d, e, f, K[2], w[2]);
+    S2Round(f, g, h, a, b, c, d, e, K[3], w[3]);
+    S2Round(e, f, g, h, a, b, c, d, K[4], w[4]);
+    S2Round(d, e, f, g, h, a, b, c, K[5], w[5]);
+    S2Round(c, d, e, f, g, h, a, b, K[6], w[6]);
+    S2Round(b, c, d, e, f, g, h, a, K[7], w[7]);
+    S2Round(a, b, c, d, e, f, g, h, K[8], w[8]);
+    S2RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    S2RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    S2RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    S2RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    S2RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    S2RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    S2RoundK(b, c, d, e, f, g, h, a, 0xC19BF27C);
+    WMIX33();
+    SHA256_RND(16);
+    WMIX();
+    SHA256_RND(32);
+    WMIX();
+    SHA256_RND(48);
+
+    s[0] += a;
+    s[1] += b;
+    s[2] += c;
+    s[3] += d;
+    s[4] += e;
+    s[5] += f;
+    s[6] += g;
+    s[7] += h;
+
+}
+
+// SHA-256 of the second block of a padded 65 byte message (uncompressed key), only w[0] is read.
+// Rounds and message schedule terms of the constant padding words are folded.
+__device__ void SHA256Transform65(uint32_t s[8], uint32_t *w)
+{
+
+    uint32_t t1;
+    uint32_t t2;
+
+    DEF(a, 0);
+    DEF(b, 1);
+    DEF(c, 2);
+    DEF(d, 3);
+    DEF(e, 4);
+    DEF(f, 5);
+    DEF(g, 6);
+    DEF(h, 7);
+
+    S2Round(a, b, c, d, e, f, g, h, K[0], w[0]);
+    S2RoundK(h, a, b, c, d, e, f, g, 0x71374491);
+    S2RoundK(g, h, a, b, c, d, e, f, 0xB5C0FBCF);
+    S2RoundK(f, g, h, a, b, c, d, e, 0xE9B5DBA5);
+    S2RoundK(e, f, g, h, a, b, c, d, 0x3956C25B);
+    S2RoundK(d, e, f, g, h, a, b, c, 0x59F111F1);
+    S2RoundK(c, d, e, f, g, h, a, b, 0x923F82A4);
+    S2RoundK(b, c, d, e, f, g, h, a, 0xAB1C5ED5);
+    S2RoundK(a, b, c, d, e, f, g, h, 0xD807AA98);
+    S2RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    S2RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    S2RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    S2RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    S2RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    S2RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    S2RoundK(b, c, d, e, f, g, h, a, 0xC19BF37C);
+    WMIX65();
+    SHA256_RND(16);
+    WMIX();
+    SHA256_RND(32);
+    WMIX();
+    SHA256_RND(48);
+
+    s[0] += a;
+    s[1] += b;
+    s[2] += c;
+    s[3] += d;
+    s[4] += e;
+    s[5] += f;
+    s[6] += g;
+    s[7] += h;
+
+}
+
 
 // ---------------------------------------------------------------------------------
 // RIPEMD160
 // ---------------------------------------------------------------------------------
-__device__ __constant__ uint64_t ripemd160_sizedesc_32 = 32 << 3;
-
 __device__ void RIPEMD160Initialize(uint32_t s[5])
 {
 
@@ -475,6 +621,187 @@ __device__ void RIPEMD160Transform(uint32_t s[5], uint32_t *w)
     s[4] = t + b1 + c2;
 }
 
+/** RIPEMD-160 of a 32 byte message (SHA-256 digest), only w[0..7] are read, the padding words are constants. */
+__device__ void RIPEMD160Transform32(uint32_t s[5], uint32_t *w)
+{
+
+    uint32_t u;
+    uint32_t a1 = s[0], b1 = s[1], c1 = s[2], d1 = s[3], e1 = s[4];
+    uint32_t a2 = a1, b2 = b1, c2 = c1, d2 = d1, e2 = e1;
+
+    R11(a1, b1, c1, d1, e1, w[0], 11);
+    R12(a2, b2, c2, d2, e2, w[5], 8);
+    R11(e1, a1, b1, c1, d1, w[1], 14);
+    R12(e2, a2, b2, c2, d2, 0x100, 9);
+    R11(d1, e1, a1, b1, c1, w[2], 15);
+    R12(d2, e2, a2, b2, c2, w[7], 9);
+    R11(c1, d1, e1, a1, b1, w[3], 12);
+    R12(c2, d2, e2, a2, b2, w[0], 11);
+    R11(b1, c1, d1, e1, a1, w[4], 5);
+    R12(b2, c2, d2, e2, a2, 0, 13);
+    R11(a1, b1, c1, d1, e1, w[5], 8);
+    R12(a2, b2, c2, d2, e2, w[2], 15);
+    R11(e1, a1, b1, c1, d1, w[6], 7);
+    R12(e2, a2, b2, c2, d2, 0, 15);
+    R11(d1, e1, a1, b1, c1, w[7], 9);
+    R12(d2, e2, a2, b2, c2, w[4], 5);
+    R11(c1, d1, e1, a1, b1, 0x80, 11);
+    R12(c2, d2, e2, a2, b2, 0, 7);
+    R11(b1, c1, d1, e1, a1, 0, 13);
+    R12(b2, c2, d2, e2, a2, w[6], 7);
+    R11(a1, b1, c1, d1, e1, 0, 14);
+    R12(a2, b2, c2, d2, e2, 0, 8);
+    R11(e1, a1, b1, c1, d1, 0, 15);
+    R12(e2, a2, b2, c2, d2, 0x80, 11);
+    R11(d1, e1, a1, b1, c1, 0, 6);
+    R12(d2, e2, a2, b2, c2, w[1], 14);
+    R11(c1, d1, e1, a1, b1, 0, 7);
+    R12(c2, d2, e2, a2, b2, 0, 14);
+    R11(b1, c1, d1, e1, a1, 0x100, 9);
+    R12(b2, c2, d2, e2, a2, w[3], 12);
+    R11(a1, b1, c1, d1, e1, 0, 8);
+    R12(a2, b2, c2, d2, e2, 0, 6);
+
+    R21(e1, a1, b1, c1, d1, w[7], 7);
+    R22(e2, a2, b2, c2, d2, w[6], 9);
+    R21(d1, e1, a1, b1, c1, w[4], 6);
+    R22(d2, e2, a2, b2, c2, 0, 13);
+    R21(c1, d1, e1, a1, b1, 0, 8);
+    R22(c2, d2, e2, a2, b2, w[3], 15);
+    R21(b1, c1, d1, e1, a1, w[1], 13);
+    R22(b2, c2, d2, e2, a2, w[7], 7);
+    R21(a1, b1, c1, d1, e1, 0, 11);
+    R22(a2, b2, c2, d2, e2, w[0], 12);
+    R21(e1, a1, b1, c1, d1, w[6], 9);
+    R22(e2, a2, b2, c2, d2, 0, 8);
+    R21(d1, e1, a1, b1, c1, 0, 7);
+    R22(d2, e2, a2, b2, c2, w[5], 9);
+    R21(c1, d1, e1, a1, b1, w[3], 15);
+    R22(c2, d2, e2, a2, b2, 0, 11);
+    R21(b1, c1, d1, e1, a1, 0, 7);
+    R22(b2, c2, d2, e2, a2, 0x100, 7);
+    R21(a1, b1, c1, d1, e1, w[0], 12);
+    R22(a2, b2, c2, d2, e2, 0, 7);
+    R21(e1, a1, b1, c1, d1, 0, 15);
+    R22(e2, a2, b2, c2, d2, 0x80, 12);
+    R21(d1, e1, a1, b1, c1, w[5], 9);
+    R22(d2, e2, a2, b2, c2, 0, 7);
+    R21(c1, d1, e1, a1, b1, w[2], 11);
+    R22(c2, d2, e2, a2, b2, w[4], 6);
+    R21(b1, c1, d1, e1, a1, 0x100, 7);
+    R22(b2, c2, d2, e2, a2, 0, 15);
+    R21(a1, b1, c1, d1, e1, 0, 13);
+    R22(a2, b2, c2, d2, e2, w[1], 13);
+    R21(e1, a1, b1, c1, d1, 0x80, 12);
+    R22(e2, a2, b2, c2, d2, w[2], 11);
+
+    R31(d1, e1, a1, b1, c1, w[3], 11);
+    R32(d2, e2, a2, b2, c2, 0, 9);
+    R31(c1, d1, e1, a1, b1, 0, 13);
+    R32(c2, d2, e2, a2, b2, w[5], 7);
+    R31(b1, c1, d1, e1, a1, 0x100, 6);
+    R32(b2, c2, d2, e2, a2, w[1], 15);
+    R31(a1, b1, c1, d1, e1, w[4], 7);
+    R32(a2, b2, c2, d2, e2, w[3], 11);
+    R31(e1, a1, b1, c1, d1, 0, 14);
+    R32(e2, a2, b2, c2, d2, w[7], 8);
+    R31(d1, e1, a1, b1, c1, 0, 9);
+    R32(d2, e2, a2, b2, c2, 0x100, 6);
+    R31(c1, d1, e1, a1, b1, 0x80, 13);
+    R32(c2, d2, e2, a2, b2, w[6], 6);
+    R31(b1, c1, d1, e1, a1, w[1], 15);
+    R32(b2, c2, d2, e2, a2, 0, 14);
+    R31(a1, b1, c1, d1, e1, w[2], 14);
+    R32(a2, b2, c2, d2, e2, 0, 12);
+    R31(e1, a1, b1, c1, d1, w[7], 8);
+    R32(e2, a2, b2, c2, d2, 0x80, 13);
+    R31(d1, e1, a1, b1, c1, w[0], 13);
+    R32(d2, e2, a2, b2, c2, 0, 5);
+    R31(c1, d1, e1, a1, b1, w[6], 6);
+    R32(c2, d2, e2, a2, b2, w[2], 14);
+    R31(b1, c1, d1, e1, a1, 0, 5);
+    R32(b2, c2, d2, e2, a2, 0, 13);
+    R31(a1, b1, c1, d1, e1, 0, 12);
+    R32(a2, b2, c2, d2, e2, w[0], 13);
+    R31(e1, a1, b1, c1, d1, w[5], 7);
+    R32(e2, a2, b2, c2, d2, w[4], 7);
+    R31(d1, e1, a1, b1, c1, 0, 5);
+    R32(d2, e2, a2, b2, c2, 0, 5);
+
+    R41(c1, d1, e1, a1, b1, w[1], 11);
+    R42(c2, d2, e2, a2, b2, 0x80, 15);
+    R41(b1, c1, d1, e1, a1, 0, 12);
+    R42(b2, c2, d2, e2, a2, w[6], 5);
+    R41(a1, b1, c1, d1, e1, 0, 14);
+    R42(a2, b2, c2, d2, e2, w[4], 8);
+    R41(e1, a1, b1, c1, d1, 0, 15);
+    R42(e2, a2, b2, c2, d2, w[1], 11);
+    R41(d1, e1, a1, b1, c1, w[0], 14);
+    R42(d2, e2, a2, b2, c2, w[3], 14);
+    R41(c1, d1, e1, a1, b1, 0x80, 15);
+    R42(c2, d2, e2, a2, b2, 0, 14);
+    R41(b1, c1, d1, e1, a1, 0, 9);
+    R42(b2, c2, d2, e2, a2, 0, 6);
+    R41(a1, b1, c1, d1, e1, w[4], 8);
+    R42(a2, b2, c2, d2, e2, w[0], 14);
+    R41(e1, a1, b1, c1, d1, 0, 9);
+    R42(e2, a2, b2, c2, d2, w[5], 6);
+    R41(d1, e1, a1, b1, c1, w[3], 14);
+    R42(d2, e2, a2, b2, c2, 0, 9);
+    R41(c1, d1, e1, a1, b1, w[7], 5);
+    R42(c2, d2, e2, a2, b2, w[2], 12);
+    R41(b1, c1, d1, e1, a1, 0, 6);
+    R42(b2, c2, d2, e2, a2, 0, 9);
+    R41(a1, b1, c1, d1, e1, 0x100, 8);
+    R42(a2, b2, c2, d2, e2, 0, 12);
+    R41(e1, a1, b1, c1, d1, w[5], 6);
+    R42(e2, a2, b2, c2, d2, w[7], 5);
+    R41(d1, e1, a1, b1, c1, w[6], 5);
+    R42(d2, e2, a2, b2, c2, 0, 15);
+    R41(c1, d1, e1, a1, b1, w[2], 12);
+    R42(c2, d2, e2, a2, b2, 0x100, 8);
+
+    R51(b1, c1, d1, e1, a1, w[4], 9);
+    R52(b2, c2, d2, e2, a2, 0, 8);
+    R51(a1, b1, c1, d1, e1, w[0], 15);
+    R52(a2, b2, c2, d2, e2, 0, 5);
+    R51(e1, a1, b1, c1, d1, w[5], 5);
+    R52(e2, a2, b2, c2, d2, 0, 12);
+    R51(d1, e1, a1, b1, c1, 0, 11);
+    R52(d2, e2, a2, b2, c2, w[4], 9);
+    R51(c1, d1, e1, a1, b1, w[7], 6);
+    R52(c2, d2, e2, a2, b2, w[1], 12);
+    R51(b1, c1, d1, e1, a1, 0, 8);
+    R52(b2, c2, d2, e2, a2, w[5], 5);
+    R51(a1, b1, c1, d1, e1, w[2], 13);
+    R52(a2, b2, c2, d2, e2, 0x80, 14);
+    R51(e1, a1, b1, c1, d1, 0, 12);
+    R52(e2, a2, b2, c2, d2, w[7], 6);
+    R51(d1, e1, a1, b1, c1, 0x100, 5);
+    R52(d2, e2, a2, b2, c2, w[6], 8);
+    R51(c1, d1, e1, a1, b1, w[1], 12);
+    R52(c2, d2, e2, a2, b2, w[2], 13);
+    R51(b1, c1, d1, e1, a1, w[3], 13);
+    R52(b2, c2, d2, e2, a2, 0, 6);
+    R51(a1, b1, c1, d1, e1, 0x80, 14);
+    R52(a2, b2, c2, d2, e2, 0x100, 5);
+    R51(e1, a1, b1, c1, d1, 0, 11);
+    R52(e2, a2, b2, c2, d2, w[0], 15);
+    R51(d1, e1, a1, b1, c1, w[6], 8);
+    R52(d2, e2, a2, b2, c2, w[3], 13);
+    R51(c1, d1, e1, a1, b1, 0, 5);
+    R52(c2, d2, e2, a2, b2, 0, 11);
+    R51(b1, c1, d1, e1, a1, 0, 6);
+    R52(b2, c2, d2, e2, a2, 0, 11);
+
+    uint32_t t = s[0];
+    s[0] = s[1] + c1 + d2;
+    s[1] = s[2] + d1 + e2;
+    s[2] = s[3] + e1 + a2;
+    s[3] = s[4] + a1 + b2;
+    s[4] = t + b1 + c2;
+}
+
 // ---------------------------------------------------------------------------------
 // Key encoding
 // ---------------------------------------------------------------------------------
@@ -484,7 +811,7 @@ __device__ __noinline__ void _GetHash160Comp(uint64_t *x, uint8_t isOdd, uint8_t
 
     uint32_t *x32 = (uint32_t *)(x);
     uint32_t publicKeyBytes[16];
-    uint32_t s[16];
+    uint32_t s[8];
 
     // Compressed public key
     publicKeyBytes[0] = __byte_perm(x32[7], 0x2 + isOdd, 0x4321);
@@ -496,28 +823,16 @@ __device__ __noinline__ void _GetHash160Comp(uint64_t *x, uint8_t isOdd, uint8_t
     publicKeyBytes[6] = __byte_perm(x32[2], x32[1], 0x0765);
     publicKeyBytes[7] = __byte_perm(x32[1], x32[0], 0x0765);
     publicKeyBytes[8] = __byte_perm(x32[0], 0x80, 0x0456);
-    publicKeyBytes[9] = 0;
-    publicKeyBytes[10] = 0;
-    publicKeyBytes[11] = 0;
-    publicKeyBytes[12] = 0;
-    publicKeyBytes[13] = 0;
-    publicKeyBytes[14] = 0;
-    publicKeyBytes[15] = 0x108;
 
     SHA256Initialize(s);
-    SHA256Transform(s, publicKeyBytes);
+    SHA256Transform33(s, publicKeyBytes);
 
 #pragma unroll 8
     for (int i = 0; i < 8; i++)
         s[i] = bswap32(s[i]);
 
-    *(uint64_t *)(s + 8) = 0x80ULL;
-    *(uint64_t *)(s + 10) = 0ULL;
-    *(uint64_t *)(s + 12) = 0ULL;
-    *(uint64_t *)(s + 14) = ripemd160_sizedesc_32;
-
     RIPEMD160Initialize((uint32_t *)hash);
-    RIPEMD160Transform((uint32_t *)hash, s);
+    RIPEMD160Transform32((uint32_t *)hash, s);
 
 }
 
@@ -527,7 +842,7 @@ __device__ __noinline__ void _GetHash160CompSym(uint64_t *x, uint8_t *h1, uint8_
     uint32_t *x32 = (uint32_t *)(x);
     uint32_t publicKeyBytes[16];
     uint32_t publicKeyBytes2[16];
-    uint32_t s[16];
+    uint32_t s[8];
 
     // Compressed public key
 
@@ -541,13 +856,6 @@ __device__ __noinline__ void _GetHash160CompSym(uint64_t *x, uint8_t *h1, uint8_
     publicKeyBytes[6] = __byte_perm(x32[2], x32[1], 0x0765);
     publicKeyBytes[7] = __byte_perm(x32[1], x32[0], 0x0765);
     publicKeyBytes[8] = __byte_perm(x32[0], 0x80, 0x0456);
-    publicKeyBytes[9] = 0;
-    publicKeyBytes[10] = 0;
-    publicKeyBytes[11] = 0;
-    publicKeyBytes[12] = 0;
-    publicKeyBytes[13] = 0;
-    publicKeyBytes[14] = 0;
-    publicKeyBytes[15] = 0x108;
 
     // Odd
     publicKeyBytes2[0] = __byte_perm(x32[7], 0x3, 0x4321);
@@ -555,35 +863,27 @@ __device__ __noinline__ void _GetHash160CompSym(uint64_t *x, uint8_t *h1, uint8_
     *(uint64_t *)(&publicKeyBytes2[2]) = *(uint64_t *)(&publicKeyBytes[2]);
     *(uint64_t *)(&publicKeyBytes2[4]) = *(uint64_t *)(&publicKeyBytes[4]);
     *(uint64_t *)(&publicKeyBytes2[6]) = *(uint64_t *)(&publicKeyBytes[6]);
-    *(uint64_t *)(&publicKeyBytes2[8]) = *(uint64_t *)(&publicKeyBytes[8]);
-    *(uint64_t *)(&publicKeyBytes2[10]) = *(uint64_t *)(&publicKeyBytes[10]);
-    *(uint64_t *)(&publicKeyBytes2[12]) = *(uint64_t *)(&publicKeyBytes[12]);
-    *(uint64_t *)(&publicKeyBytes2[14]) = *(uint64_t *)(&publicKeyBytes[14]);
+    publicKeyBytes2[8] = publicKeyBytes[8];
 
     SHA256Initialize(s);
-    SHA256Transform(s, publicKeyBytes);
+    SHA256Transform33(s, publicKeyBytes);
 
 #pragma unroll 8
     for (int i = 0; i < 8; i++)
         s[i] = bswap32(s[i]);
 
-    *(uint64_t *)(s + 8) = 0x80ULL;
-    *(uint64_t *)(s + 10) = 0ULL;
-    *(uint64_t *)(s + 12) = 0ULL;
-    *(uint64_t *)(s + 14) = ripemd160_sizedesc_32;
-
     RIPEMD160Initialize((uint32_t *)h1);
-    RIPEMD160Transform((uint32_t *)h1, s);
+    RIPEMD160Transform32((uint32_t *)h1, s);
 
     SHA256Initialize(s);
-    SHA256Transform(s, publicKeyBytes2);
+    SHA256Transform33(s, publicKeyBytes2);
 
 #pragma unroll 8
     for (int i = 0; i < 8; i++)
         s[i] = bswap32(s[i]);
 
     RIPEMD160Initialize((uint32_t *)h2);
-    RIPEMD160Transform((uint32_t *)h2, s);
+    RIPEMD160Transform32((uint32_t *)h2, s);
 
 }
 
@@ -593,7 +893,7 @@ __device__ __noinline__ void _GetHash160(uint64_t *x, uint64_t *y, uint8_t *hash
     uint32_t *x32 = (uint32_t *)(x);
     uint32_t *y32 = (uint32_t *)(y);
     uint32_t publicKeyBytes[32];
-    uint32_t s[16];
+    uint32_t s[8];
 
     // Uncompressed public key
     publicKeyBytes[0] = __byte_perm(x32[7], 0x04, 0x4321);
@@ -613,47 +913,26 @@ __device__ __noinline__ void _GetHash160(uint64_t *x, uint64_t *y, uint8_t *hash
     publicKeyBytes[14] = __byte_perm(y32[2], y32[1], 0x0765);
     publicKeyBytes[15] = __byte_perm(y32[1], y32[0], 0x0765);
     publicKeyBytes[16] = __byte_perm(y32[0], 0x80, 0x0456);
-    publicKeyBytes[17] = 0;
-    publicKeyBytes[18] = 0;
-    publicKeyBytes[19] = 0;
-    publicKeyBytes[20] = 0;
-    publicKeyBytes[21] = 0;
-    publicKeyBytes[22] = 0;
-    publicKeyBytes[23] = 0;
-    publicKeyBytes[24] = 0;
-    publicKeyBytes[25] = 0;
-    publicKeyBytes[26] = 0;
-    publicKeyBytes[27] = 0;
-    publicKeyBytes[28] = 0;
-    publicKeyBytes[29] = 0;
-    publicKeyBytes[30] = 0;
-    publicKeyBytes[31] = 0x208;
 
     SHA256Initialize(s);
     SHA256Transform(s, publicKeyBytes);
-    SHA256Transform(s, publicKeyBytes + 16);
+    SHA256Transform65(s, publicKeyBytes + 16);
 
 #pragma unroll 8
     for (int i = 0; i < 8; i++)
         s[i] = bswap32(s[i]);
 
-    *(uint64_t *)(s + 8) = 0x80ULL;
-    *(uint64_t *)(s + 10) = 0ULL;
-    *(uint64_t *)(s + 12) = 0ULL;
-    *(uint64_t *)(s + 14) = ripemd160_sizedesc_32;
-
     RIPEMD160Initialize((uint32_t *)hash);
-    RIPEMD160Transform((uint32_t *)hash, s);
+    RIPEMD160Transform32((uint32_t *)hash, s);
 
 }
 
-__device__ __noinline__ void _GetHash160P2SHComp(uint64_t *x, uint8_t isOdd, uint8_t *hash)
+// Hash160 of the 1 to 1 redeem script (0x0014 followed by the key hash h)
+__device__ __noinline__ void _GetHash160Script(uint32_t *h, uint8_t *hash)
 {
 
-    uint32_t h[5];
     uint32_t scriptBytes[16];
-    uint32_t s[16];
-    _GetHash160Comp(x, isOdd, (uint8_t *)h);
+    uint32_t s[8];
 
     // P2SH script script
     scriptBytes[0] = __byte_perm(h[0], 0x14, 0x5401);
@@ -680,55 +959,25 @@ __device__ __noinline__ void _GetHash160P2SHComp(uint64_t *x, uint8_t isOdd, uin
     for (int i = 0; i < 8; i++)
         s[i] = bswap32(s[i]);
 
-    *(uint64_t *)(s + 8) = 0x80ULL;
-    *(uint64_t *)(s + 10) = 0ULL;
-    *(uint64_t *)(s + 12) = 0ULL;
-    *(uint64_t *)(s + 14) = ripemd160_sizedesc_32;
-
     RIPEMD160Initialize((uint32_t *)hash);
-    RIPEMD160Transform((uint32_t *)hash, s);
+    RIPEMD160Transform32((uint32_t *)hash, s);
 
 }
 
-__device__ __noinline__ void _GetHash160P2SHUncomp(uint64_t *x, uint64_t *y, uint8_t *hash)
+__device__ __noinline__ void _GetHash160P2SHComp(uint64_t *x, uint8_t isOdd, uint8_t *hash)
 {
 
     uint32_t h[5];
-    uint32_t scriptBytes[16];
-    uint32_t s[16];
-    _GetHash160(x, y, (uint8_t *)h);
-
-    // P2SH script script
-    scriptBytes[0] = __byte_perm(h[0], 0x14, 0x5401);
-    scriptBytes[1] = __byte_perm(h[0], h[1], 0x2345);
-    scriptBytes[2] = __byte_perm(h[1], h[2], 0x2345);
-    scriptBytes[3] = __byte_perm(h[2], h[3], 0x2345);
-    scriptBytes[4] = __byte_perm(h[3], h[4], 0x2345);
-    scriptBytes[5] = __byte_perm(h[4], 0x80, 0x2345);
-    scriptBytes[6] = 0;
-    scriptBytes[7] = 0;
-    scriptBytes[8] = 0;
-    scriptBytes[9] = 0;
-    scriptBytes[10] = 0;
-    scriptBytes[11] = 0;
-    scriptBytes[12] = 0;
-    scriptBytes[13] = 0;
-    scriptBytes[14] = 0;
-    scriptBytes[15] = 0xB0;
-
-    SHA256Initialize(s);
-    SHA256Transform(s, scriptBytes);
+    _GetHash160Comp(x, isOdd, (uint8_t *)h);
+    _GetHash160Script(h, hash);
 
-#pragma unroll 8
-    for (int i = 0; i < 8; i++)
-        s[i] = bswap32(s[i]);
+}
 
-    *(uint64_t *)(s + 8) = 0x80ULL;
-    *(uint64_t *)(s + 10) = 0ULL;
-    *(uint64_t *)(s + 12) = 0ULL;
-    *(uint64_t *)(s + 14) = ripemd160_sizedesc_32;
+__device__ __noinline__ void _GetHash160P2SHUncomp(uint64_t *x, uint64_t *y, uint8_t *hash)
+{
 
-    RIPEMD160Initialize((uint32_t *)hash);
-    RIPEMD160Transform((uint32_t *)hash, s);
+    uint32_t h[5];
+    _GetHash160(x, y, (uint8_t *)h);
+    _GetHash160Script(h, hash);
 
 }
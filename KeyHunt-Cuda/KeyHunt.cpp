@@ -5,13 +5,20 @@
 #include "hash/sha512.h"
 #include "IntGroup.h"
 #include "Timer.h"
+#include "TargetSort.h"
 #include "hash/ripemd160.h"
 #include <cstring>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
+#include <emmintrin.h>
 #ifndef WIN64
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #endif
 
 using namespace std;
@@ -21,20 +28,205 @@ Point _2Gn;
 
 // ----------------------------------------------------------------------------
 
+GroupRing::GroupRing()
+{
+	slots = new CPU_GROUP[CPU_RING_SIZE];
+	head = 0;
+	tail = 0;
+	closed = false;
+}
+
+GroupRing::~GroupRing()
+{
+	delete[] slots;
+}
+
+// Producer side, return the next free slot or NULL if the ring is full
+CPU_GROUP* GroupRing::BeginWrite()
+{
+	uint32_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) >= CPU_RING_SIZE)
+		return NULL;
+	return slots + (h % CPU_RING_SIZE);
+}
+
+void GroupRing::EndWrite()
+{
+	head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Consumer side, return the oldest filled slot or NULL if the ring is empty
+CPU_GROUP* GroupRing::BeginRead()
+{
+	uint32_t t = tail.load(std::memory_order_relaxed);
+	if (head.load(std::memory_order_acquire) == t)
+		return NULL;
+	return slots + (t % CPU_RING_SIZE);
+}
+
+void GroupRing::EndRead()
+{
+	tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void GroupRing::Close()
+{
+	closed.store(true, std::memory_order_release);
+}
+
+bool GroupRing::IsClosed()
+{
+	return closed.load(std::memory_order_acquire);
+}
+
+// ----------------------------------------------------------------------------
+
+// Back off while the other stage catches up. pause keeps the sibling
+// hyperthread fed, a long wait gives the core back to the scheduler.
+static void waitSpin(int& spin)
+{
+	if (spin++ < 64) {
+		_mm_pause();
+	}
+	else {
+#ifdef WIN64
+		SwitchToThread();
+#else
+		sched_yield();
+#endif
+	}
+}
+
+// Pin the calling thread on a logical CPU
+static void pinThread(int cpu)
+{
+	if (cpu < 0)
+		return;
+#ifdef WIN64
+	SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#else
+	cpu_set_t cpuset;
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+}
+
+// Build the list of (EC, hash) logical CPU pairs, SMT siblings of the same
+// core first. Cores without sibling are paired together.
+static void getSMTPairs(vector<int>& cpus)
+{
+#ifdef WIN64
+	SYSTEM_INFO sysinfo;
+	GetSystemInfo(&sysinfo);
+	int nbCpu = sysinfo.dwNumberOfProcessors;
+	if (nbCpu > 64)
+		nbCpu = 64;
+#else
+	int nbCpu = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	if (nbCpu > CPU_SETSIZE)
+		nbCpu = CPU_SETSIZE;
+#endif
+	if (nbCpu < 1)
+		nbCpu = 1;
+
+	vector<bool> used(nbCpu, false);
+	vector<int> single;
+	cpus.clear();
+
+	for (int i = 0; i < nbCpu; i++) {
+
+		if (used[i])
+			continue;
+		used[i] = true;
+		int sibling = -1;
+
+#ifdef WIN64
+		// Windows enumerates the hyperthreads of a core consecutively
+		if ((i & 1) == 0 && i + 1 < nbCpu)
+			sibling = i + 1;
+#else
+		char path[128];
+		char list[256];
+		sprintf(path, "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", i);
+		FILE* f = fopen(path, "r");
+		if (f) {
+			if (fgets(list, sizeof(list), f)) {
+				// Format: "0,4" or "0-1"
+				char* s = list;
+				while (*s && sibling < 0) {
+					int a = (int)strtol(s, &s, 10);
+					int b = a;
+					if (*s == '-')
+						b = (int)strtol(s + 1, &s, 10);
+					for (int c = a; c <= b && sibling < 0; c++)
+						if (c != i && c < nbCpu && !used[c])
+							sibling = c;
+					if (*s != ',')
+						break;
+					s++;
+				}
+			}
+			fclose(f);
+		}
+#endif
+
+		if (sibling >= 0) {
+			used[sibling] = true;
+			cpus.push_back(i);
+			cpus.push_back(sibling);
+		}
+		else {
+			single.push_back(i);
+		}
+
+	}
+
+	for (size_t i = 0; i + 1 < single.size(); i += 2) {
+		cpus.push_back(single[i]);
+		cpus.push_back(single[i + 1]);
+	}
+	if (single.size() % 2) {
+		// Lonely core runs both stages
+		cpus.push_back(single.back());
+		cpus.push_back(single.back());
+	}
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef WIN64
+DWORD WINAPI _BuildFilter(LPVOID lpParam)
+{
+#else
+void* _BuildFilter(void* lpParam)
+{
+#endif
+	FILTER_PARAM* p = (FILTER_PARAM*)lpParam;
+	p->obj->BuildFilter(p);
+	return 0;
+}
+
+// ----------------------------------------------------------------------------
+
 KeyHunt::KeyHunt(const std::string& addressFile, const std::vector<unsigned char>& addressHash,
-	int searchMode, bool useGpu, const std::string& outputFile, bool useSSE,
-	uint32_t maxFound, const std::string& rangeStart, const std::string& rangeEnd,
+	int searchType, int searchMode, bool useSegwit, int filterFormat, int compactLen, const std::string& deltaFile,
+	bool useGpu, const std::string& outputFile, bool useSSE, bool usePipeline, uint32_t maxFound, const std::string& rangeStart, const std::string& rangeEnd,
 	bool& should_exit)
 {
+	this->searchType = searchType;
 	this->searchMode = searchMode;
+	this->useSegwit = useSegwit;
 	this->useGpu = useGpu;
 	this->outputFile = outputFile;
 	this->useSSE = useSSE;
+	this->usePipeline = usePipeline;
 	this->nbGPUThread = 0;
 	this->addressFile = addressFile;
 	//this->addressHash = addressHash;
 	this->maxFound = maxFound;
-	this->searchType = P2PKH;
+	this->DATA_LEN = (searchType == XPOINT) ? 32 : 20;
+	this->compactLen = compactLen;
 	this->rangeStart.SetBase16(rangeStart.c_str());
 	if (rangeEnd.length() <= 0) {
 		this->rangeEnd.Set(&this->rangeStart);
@@ -50,6 +242,21 @@ KeyHunt::KeyHunt(const std::string& addressFile, const std::vector<unsigned char
 		}
 	}
 	this->rangeDiff.SetInt32(0);
+	this->bloom = NULL;
+	this->fuse = NULL;
+	this->index = NULL;
+	this->tree = NULL;
+	this->cache = NULL;
+	this->prefilter = NULL;
+	this->set = NULL;
+	this->deltaFile = deltaFile;
+	this->delta = NULL;
+	this->deltaGeneration = 0;
+	this->retiredDelta = NULL;
+	this->deltaTime = 0;
+	this->DATA = NULL;
+	this->PREFIX = NULL;
+	this->shouldExit = &should_exit;
 
 	this->addressMode = FILEMODE;
 	if (addressHash.size() > 0 && this->addressFile.length() <= 0)
@@ -60,70 +267,163 @@ KeyHunt::KeyHunt(const std::string& addressFile, const std::vector<unsigned char
 
 	if (this->addressMode == FILEMODE) {
 
-		// load address file
-		uint8_t buf[20];
-		FILE* wfd;
-		uint64_t N = 0;
+		// The sorted target file is mapped and used in place, no copy.
+		// Unsorted files are sorted and deduplicated once and written back.
+		uint64_t N = MapTargets();
+		if (!TargetsSorted(DATA, N, DATA_LEN, Timer::getCoreNumber())) {
+			printf("Sorting      : %s is not sorted, sorting and removing duplicates\n", addressFile.c_str());
+			UnmapTargets();
+			SortTargetFile(addressFile, DATA_LEN, Timer::getCoreNumber(), SortMemoryLimit());
+			N = MapTargets();
+		}
+		TOTAL_ADDR = N;
+		printf("\n");
+		printf("Loaded       : %s %s\n", formatThousands(N).c_str(), (searchType == XPOINT) ? "x point" : "address");
+
+		// Compact store, the index works on the prefixes and the mapping is
+		// released once the filter is ready
+		if (compactLen > 0) {
+			PREFIX = (uint8_t*)malloc((size_t)(N * compactLen));
+			if (PREFIX == NULL) {
+				printf("Compact store: out of memory\n");
+				exit(1);
+			}
+			for (uint64_t i = 0; i < N; i++)
+				memcpy(PREFIX + i * compactLen, DATA + i * DATA_LEN, compactLen);
+		}
 
-		wfd = fopen(this->addressFile.c_str(), "rb");
-		if (!wfd) {
-			printf("%s can not open\n", this->addressFile.c_str());
-			exit(1);
+		// The fuse filter and the tree are built once all the targets are loaded
+		bool useFuse = (filterFormat == FILTER_FUSE8 || filterFormat == FILTER_FUSE16);
+		bool useTree = (filterFormat == FILTER_TREE);
+
+		// The filter and the index of a previous run are reused while the
+		// target file is unchanged
+		bool cached = false;
+		if (!useTree) {
+			cache = new FilterCache(addressFile, filterFormat, DATA_LEN, DATA, DATA_SIZE, Timer::getCoreNumber());
+			cached = LoadCache(N, filterFormat);
 		}
 
+		if (!cached && !useFuse && !useTree) {
+
+			// Bloom filter, each thread adds a slice of the targets
+			bloom = new Bloom(2 * N, 0.000001, filterFormat);
+			int nbThread = Timer::getCoreNumber();
+			if (nbThread < 1 || N < 65536)
+				nbThread = 1;
+			FILTER_PARAM* params = (FILTER_PARAM*)malloc(nbThread * sizeof(FILTER_PARAM));
 #ifdef WIN64
-		_fseeki64(wfd, 0, SEEK_END);
-		N = _ftelli64(wfd);
+			HANDLE* threads = (HANDLE*)malloc(nbThread * sizeof(HANDLE));
 #else
-		fseek(wfd, 0, SEEK_END);
-		N = ftell(wfd);
+			pthread_t* threads = (pthread_t*)malloc(nbThread * sizeof(pthread_t));
+#endif
+			for (int t = 0; t < nbThread; t++) {
+				params[t].obj = this;
+				params[t].threadId = t;
+				params[t].start = N * t / nbThread;
+				params[t].end = N * (t + 1) / nbThread;
+				params[t].concurrent = (nbThread > 1);
+#ifdef WIN64
+				DWORD thread_id;
+				threads[t] = CreateThread(NULL, 0, _BuildFilter, (void*)(params + t), 0, &thread_id);
+#else
+				pthread_create(&threads[t], NULL, &_BuildFilter, (void*)(params + t));
+#endif
+			}
+			for (int t = 0; t < nbThread; t++) {
+#ifdef WIN64
+				WaitForSingleObject(threads[t], INFINITE);
+				CloseHandle(threads[t]);
+#else
+				pthread_join(threads[t], NULL);
 #endif
-		N = N / 20;
-		rewind(wfd);
-
-		DATA = (uint8_t*)malloc(N * 20);
-		memset(DATA, 0, N * 20);
-
-		bloom = new Bloom(2 * N, 0.000001);
-
-		uint64_t percent = (N - 1) / 100;
-		uint64_t i = 0;
-		printf("\n");
-		while (i < N && !should_exit) {
-			memset(buf, 0, 20);
-			memset(DATA + (i * 20), 0, 20);
-			if (fread(buf, 1, 20, wfd) == 20) {
-				bloom->add(buf, 20);
-				memcpy(DATA + (i * 20), buf, 20);
-				if (i % percent == 0) {
-					printf("\rLoading      : %llu %%", (i / percent));
-					fflush(stdout);
-				}
 			}
-			i++;
+			free(threads);
+			free(params);
+			printf("\n");
+
 		}
 		printf("\n");
-		fclose(wfd);
+
+		// Cache resident first level filter, skipped when the targets would saturate it
+		if (PreFilter::useful(N))
+			prefilter = new PreFilter(DATA, N, DATA_LEN);
 
 		if (should_exit) {
 			delete secp;
+			delete prefilter;
 			delete bloom;
-			if (DATA)
-				free(DATA);
+			delete fuse;
+			delete index;
+			delete cache;
+			UnmapTargets();
 			exit(0);
 		}
 
-		BLOOM_N = bloom->get_bytes();
-		TOTAL_ADDR = N;
-		printf("Loaded       : %s address\n", formatThousands(i).c_str());
-		printf("\n");
+		if (useTree) {
+			tree = new TargetTree(DATA, N, DATA_LEN);
+			BLOOM_N = 0;
+			tree->print();
+		}
+		else {
+			if (!cached) {
+				if (useFuse) {
+					fuse = new FuseFilter(DATA, N, DATA_LEN, filterFormat);
+					if (!fuse->get_ready()) {
+						printf("Fuse filter can not be built from these targets, use -y bloom\n");
+						exit(1);
+					}
+				}
+				if (PREFIX)
+					index = new TargetIndex(PREFIX, N, compactLen);
+				else
+					index = new TargetIndex(DATA, N, DATA_LEN);
+				SaveCache();
+			}
+
+			if (useFuse) {
+				BLOOM_N = fuse->get_bytes();
+				fuse->print();
+			}
+			else {
+				BLOOM_N = bloom->get_bytes();
+				bloom->print();
+			}
+			printf("\n");
 
-		bloom->print();
+			if (PREFIX) {
+				if (!index->open_records(addressFile, DATA_LEN)) {
+					printf("%s can not open\n", addressFile.c_str());
+					exit(1);
+				}
+				UnmapTargets();
+			}
+			index->print();
+		}
+		if (prefilter) {
+			printf("\n");
+			prefilter->print();
+		}
 		printf("\n");
+
+		if (deltaFile.length() > 0) {
+			ReloadDelta(NULL, 0);
+			if (delta == NULL)
+				printf("Delta        : %s is watched\n", deltaFile.c_str());
+			printf("\n");
+		}
 	}
 	else {
-		for (size_t i = 0; i < addressHash.size(); i++) {
-			((uint8_t*)hash160)[i] = addressHash.at(i);
+		// One or a few targets, matched in an L1 resident sorted prefix array
+		if (addressHash.size() % DATA_LEN != 0) {
+			printf("Invalid targets, %d bytes records expected\n", DATA_LEN);
+			exit(1);
+		}
+		set = new TargetSet(addressHash.data(), (int)(addressHash.size() / DATA_LEN), DATA_LEN);
+		TOTAL_ADDR = set->get_count();
+		if (TOTAL_ADDR > 1) {
+			printf("\n");
+			set->print();
 		}
 		printf("\n");
 	}
@@ -163,10 +463,237 @@ KeyHunt::KeyHunt(const std::string& addressFile, const std::vector<unsigned char
 KeyHunt::~KeyHunt()
 {
 	delete secp;
-	if (this->addressMode == FILEMODE)
+	if (this->addressMode == FILEMODE) {
 		delete bloom;
+		delete fuse;
+		delete index;
+		delete tree;
+		delete cache;
+		delete prefilter;
+		delete delta.load();
+		delete retiredDelta;
+		free(PREFIX);
+	}
+	else {
+		delete set;
+	}
+	UnmapTargets();
+}
+
+// ----------------------------------------------------------------------------
+
+uint64_t KeyHunt::MapTargets()
+{
+#ifdef WIN64
+	dataFile = CreateFileA(addressFile.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, NULL);
+	if (dataFile == INVALID_HANDLE_VALUE) {
+		printf("%s can not open\n", addressFile.c_str());
+		exit(1);
+	}
+	LARGE_INTEGER size;
+	GetFileSizeEx(dataFile, &size);
+	DATA_SIZE = (uint64_t)size.QuadPart;
+	if (DATA_SIZE < DATA_LEN) {
+		printf("%s is empty\n", addressFile.c_str());
+		exit(1);
+	}
+	dataMapping = CreateFileMapping(dataFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	DATA = dataMapping ? (uint8_t*)MapViewOfFile(dataMapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+#else
+	int fd = open(addressFile.c_str(), O_RDONLY);
+	if (fd < 0) {
+		printf("%s can not open\n", addressFile.c_str());
+		exit(1);
+	}
+	struct stat st;
+	fstat(fd, &st);
+	DATA_SIZE = (uint64_t)st.st_size;
+	if (DATA_SIZE < DATA_LEN) {
+		printf("%s is empty\n", addressFile.c_str());
+		exit(1);
+	}
+	void* m = mmap(NULL, DATA_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	DATA = (m == MAP_FAILED) ? NULL : (uint8_t*)m;
+	// Read ahead while the filter is built
 	if (DATA)
-		free(DATA);
+		madvise(DATA, DATA_SIZE, MADV_WILLNEED);
+#endif
+	if (DATA == NULL) {
+		printf("%s can not be mapped\n", addressFile.c_str());
+		exit(1);
+	}
+
+	// A trailing partial record is ignored
+	return DATA_SIZE / DATA_LEN;
+}
+
+// Map the filter and the index from the cache, false if they must be built
+bool KeyHunt::LoadCache(uint64_t N, int filterFormat)
+{
+	if (!cache->load())
+		return false;
+
+	unsigned long long filterSize = 0;
+	unsigned long long indexSize = 0;
+	const unsigned char* filterData = cache->get_section(CACHE_FILTER, &filterSize);
+	const unsigned char* indexData = cache->get_section(CACHE_INDEX, &indexSize);
+
+	int rv;
+	if (filterFormat == FILTER_FUSE8 || filterFormat == FILTER_FUSE16) {
+		fuse = new FuseFilter();
+		rv = fuse->load(filterData, filterSize);
+	}
+	else {
+		bloom = new Bloom();
+		rv = bloom->load(filterData, filterSize);
+	}
+	if (rv == 0) {
+		if (PREFIX)
+			index = new TargetIndex(PREFIX, N, compactLen, false);
+		else
+			index = new TargetIndex(DATA, N, DATA_LEN, false);
+		rv = index->load(indexData, indexSize);
+	}
+	if (rv != 0) {
+		printf("Cache        : %s is invalid (%d), rebuilding\n", cache->get_file_name().c_str(), rv);
+		delete fuse;
+		delete bloom;
+		delete index;
+		fuse = NULL;
+		bloom = NULL;
+		index = NULL;
+		return false;
+	}
+
+	printf("Cache        : %s\n", cache->get_file_name().c_str());
+	return true;
+}
+
+// Save the filter and the index for the next runs, a failure only costs a rebuild
+void KeyHunt::SaveCache()
+{
+	FILE* f = cache->create();
+	bool ok = (f != NULL);
+	if (ok) {
+		ok = cache->section(f, CACHE_FILTER) && (fuse ? fuse->save(f) : bloom->save(f)) == 0 &&
+			cache->section(f, CACHE_INDEX) && index->save(f) == 0;
+		ok = ok ? cache->commit(f) : (cache->discard(f), false);
+	}
+	if (ok)
+		printf("Cache        : saved to %s\n", cache->get_file_name().c_str());
+	else
+		printf("Cache        : can not write %s\n", cache->get_file_name().c_str());
+}
+
+// ----------------------------------------------------------------------------
+
+// Load the delta file again when it changed. The additions are added to the
+// Bloom filter and the prefilter, which only get bits set, before the new
+// delta is published. The replaced delta is freed once every running thread
+// went through a new group and no longer uses it, a reload waits for it.
+// The counters are copied after the exchange: a group ending between a copy
+// and the exchange would move the counter of a thread still able to load the
+// old delta in its next group.
+void KeyHunt::ReloadDelta(TH_PARAM* params, int nbThread)
+{
+	if (retiredDelta) {
+		for (int i = 0; i < nbThread; i++) {
+			int thId = params[i].threadId;
+			if (params[i].isRunning && counters[thId] == retiredCounters[thId])
+				return;
+		}
+		delete retiredDelta;
+		retiredDelta = NULL;
+	}
+
+	uint64_t t = TargetDelta::file_time(deltaFile);
+	if (t == 0 || t == deltaTime)
+		return;
+	deltaTime = t;
+	if (params)
+		printf("\n");
+
+	// On error the current delta stays in use
+	TargetDelta* d = TargetDelta::load(deltaFile, DATA_LEN);
+	if (d == NULL)
+		return;
+
+	const uint8_t* a = d->get_added();
+	for (uint64_t i = 0; i < d->get_added_count(); i++) {
+		bloom->add(a + i * DATA_LEN, DATA_LEN);
+		if (prefilter)
+			prefilter->add(a + i * DATA_LEN);
+	}
+
+	retiredDelta = delta.exchange(d);
+	memcpy(retiredCounters, counters, sizeof(counters));
+	deltaGeneration++;
+
+	d->print();
+}
+
+#ifdef WITHGPU
+// The bytes of the filters holding the bits of the added targets are or-ed
+// in the GPU copies, the filters are not uploaded again
+void KeyHunt::PushDelta(GPUEngine* g)
+{
+	TargetDelta* d = delta.load(std::memory_order_acquire);
+	const uint8_t* a = d->get_added();
+	uint64_t n = d->get_added_count();
+	std::vector<uint64_t> offsets;
+	std::vector<uint8_t> values;
+
+	const uint8_t* bf = bloom->get_bf();
+	for (uint64_t i = 0; i < n; i++)
+		bloom->touched(a + i * DATA_LEN, DATA_LEN, offsets);
+	for (size_t i = 0; i < offsets.size(); i++)
+		values.push_back(bf[offsets[i]]);
+	g->UpdateFilter(offsets.data(), values.data(), (uint32_t)offsets.size(), false);
+
+	if (prefilter) {
+		offsets.clear();
+		values.clear();
+		const uint8_t* table = prefilter->get_table();
+		for (uint64_t i = 0; i < n; i++)
+			offsets.push_back(prefilter->byte_of(a + i * DATA_LEN));
+		for (size_t i = 0; i < offsets.size(); i++)
+			values.push_back(table[offsets[i]]);
+		g->UpdateFilter(offsets.data(), values.data(), (uint32_t)offsets.size(), true);
+	}
+}
+#endif
+
+void KeyHunt::UnmapTargets()
+{
+	if (DATA == NULL)
+		return;
+#ifdef WIN64
+	UnmapViewOfFile(DATA);
+	CloseHandle(dataMapping);
+	CloseHandle(dataFile);
+#else
+	munmap(DATA, DATA_SIZE);
+#endif
+	DATA = NULL;
+}
+
+void KeyHunt::BuildFilter(FILTER_PARAM* p)
+{
+	uint64_t n = p->end - p->start;
+	uint64_t percent = n / 100 + 1;
+	for (uint64_t i = p->start; i < p->end && !*shouldExit; i++) {
+		if (p->concurrent)
+			bloom->add_concurrent(DATA + i * DATA_LEN, DATA_LEN);
+		else
+			bloom->add(DATA + i * DATA_LEN, DATA_LEN);
+		// The first thread reports the progress of its slice
+		if (p->threadId == 0 && (i - p->start) % percent == 0) {
+			printf("\rLoading      : %llu %%", (i - p->start) / percent);
+			fflush(stdout);
+		}
+	}
 }
 
 // ----------------------------------------------------------------------------
@@ -177,7 +704,7 @@ double log1(double x)
 	return -x - (x * x) / 2.0 - (x * x * x) / 3.0 - (x * x * x * x) / 4.0;
 }
 
-void KeyHunt::output(string addr, string pAddr, string pAddrHex)
+void KeyHunt::output(string addr, string pAddr, string pAddrHex, int type)
 {
 
 #ifdef WIN64
@@ -203,12 +730,15 @@ void KeyHunt::output(string addr, string pAddr, string pAddrHex)
 	if (!needToClose)
 		printf("\n");
 
-	fprintf(f, "PubAddress: %s\n", addr.c_str());
+	if (type == XPOINT)
+		fprintf(f, "PubKey    : %s\n", addr.c_str());
+	else
+		fprintf(f, "PubAddress: %s\n", addr.c_str());
 
 	{
 
 
-		switch (searchType) {
+		switch (type) {
 		case P2PKH:
 			fprintf(f, "Priv (WIF): p2pkh:%s\n", pAddr.c_str());
 			break;
@@ -218,6 +748,9 @@ void KeyHunt::output(string addr, string pAddr, string pAddrHex)
 		case BECH32:
 			fprintf(f, "Priv (WIF): p2wpkh:%s\n", pAddr.c_str());
 			break;
+		case XPOINT:
+			fprintf(f, "Priv (WIF): %s\n", pAddr.c_str());
+			break;
 		}
 		fprintf(f, "Priv (HEX): 0x%s\n", pAddrHex.c_str());
 
@@ -238,7 +771,7 @@ void KeyHunt::output(string addr, string pAddr, string pAddrHex)
 
 // ----------------------------------------------------------------------------
 
-bool KeyHunt::checkPrivKey(string addr, Int& key, int32_t incr, int endomorphism, bool mode)
+bool KeyHunt::checkPrivKey(string addr, Int& key, int32_t incr, int endomorphism, bool mode, int type)
 {
 
 	Int k(&key);
@@ -265,7 +798,7 @@ bool KeyHunt::checkPrivKey(string addr, Int& key, int32_t incr, int endomorphism
 	// Check addresses
 	Point p = secp->ComputePublicKey(&k);
 
-	string chkAddr = secp->GetAddress(searchType, mode, p);
+	string chkAddr = secp->GetAddress(type, mode, p);
 	if (chkAddr != addr) {
 
 		//Key may be the opposite one (negative zero or compressed key)
@@ -273,7 +806,7 @@ bool KeyHunt::checkPrivKey(string addr, Int& key, int32_t incr, int endomorphism
 		k.Add(&secp->order);
 		p = secp->ComputePublicKey(&k);
 
-		string chkAddr = secp->GetAddress(searchType, mode, p);
+		string chkAddr = secp->GetAddress(type, mode, p);
 		if (chkAddr != addr) {
 			printf("\nWarning, wrong private key generated !\n");
 			printf("  Addr :%s\n", addr.c_str());
@@ -284,7 +817,16 @@ bool KeyHunt::checkPrivKey(string addr, Int& key, int32_t incr, int endomorphism
 
 	}
 
-	output(addr, secp->GetPrivAddress(mode, k), k.GetBase16());
+	// The key of an x point is reported with its compressed public key,
+	// if the target has the other y parity the private key is order - k
+	if (type == XPOINT)
+		addr = secp->GetPublicKeyHex(true, p);
+
+	output(addr, secp->GetPrivAddress(mode, k), k.GetBase16(), type);
+
+	// P2WPKH (bech32) shares the key hash of P2PKH
+	if (useSegwit && mode && type == P2PKH)
+		output(secp->GetAddress(BECH32, mode, p), secp->GetPrivAddress(mode, k), k.GetBase16(), BECH32);
 
 	return true;
 
@@ -304,6 +846,18 @@ void* _FindKey(void* lpParam)
 	return 0;
 }
 
+#ifdef WIN64
+DWORD WINAPI _CheckKey(LPVOID lpParam)
+{
+#else
+void* _CheckKey(void* lpParam)
+{
+#endif
+	TH_PARAM* p = (TH_PARAM*)lpParam;
+	p->obj->CheckKeyCPU(p);
+	return 0;
+}
+
 #ifdef WIN64
 DWORD WINAPI _FindKeyGPU(LPVOID lpParam)
 {
@@ -328,7 +882,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, p1, h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 0, compressed)) {
+		if (checkPrivKey(addr, key, i, 0, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -339,7 +893,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte1[0], h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 1, compressed)) {
+		if (checkPrivKey(addr, key, i, 1, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -350,7 +904,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte2[0], h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 2, compressed)) {
+		if (checkPrivKey(addr, key, i, 2, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -361,7 +915,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, p1, h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 0, compressed)) {
+		if (checkPrivKey(addr, key, -i, 0, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -371,7 +925,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte1[0], h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 1, compressed)) {
+		if (checkPrivKey(addr, key, -i, 1, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -381,7 +935,7 @@ void KeyHunt::checkAddresses(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte2[0], h0);
 	if (CheckBloomBinary(h0) > 0) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 2, compressed)) {
+		if (checkPrivKey(addr, key, -i, 2, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -397,7 +951,7 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, p1, h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 0, compressed)) {
+		if (checkPrivKey(addr, key, i, 0, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -408,7 +962,7 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte1[0], h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 1, compressed)) {
+		if (checkPrivKey(addr, key, i, 1, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -419,7 +973,7 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte2[0], h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i, 2, compressed)) {
+		if (checkPrivKey(addr, key, i, 2, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -430,7 +984,7 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, p1, h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 0, compressed)) {
+		if (checkPrivKey(addr, key, -i, 0, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -440,7 +994,7 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte1[0], h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 1, compressed)) {
+		if (checkPrivKey(addr, key, -i, 1, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
@@ -450,446 +1004,225 @@ void KeyHunt::checkAddresses2(bool compressed, Int key, int i, Point p1)
 	secp->GetHash160(searchType, compressed, pte2[0], h0);
 	if (MatchHash160((uint32_t*)h0)) {
 		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -i, 2, compressed)) {
+		if (checkPrivKey(addr, key, -i, 2, compressed, searchType)) {
 			nbFoundKey++;
 		}
 	}
 }
 // ----------------------------------------------------------------------------
 
-void KeyHunt::checkAddressesSSE(bool compressed, Int key, int i, Point p1, Point p2, Point p3, Point p4)
+// Hash and filter phases of a group of CPU_GRP_SIZE points starting at key + i,
+// coordinates were filled by checkGroup()
+void KeyHunt::checkBatch(bool compressed, Int& key, int i, CPU_HASH_BATCH* hb)
 {
-	unsigned char h0[20];
-	unsigned char h1[20];
-	unsigned char h2[20];
-	unsigned char h3[20];
-	Point pte1[4];
-	Point pte2[4];
-
-	// Point -------------------------------------------------------------------------
-	secp->GetHash160(searchType, compressed, p1, p2, p3, p4, h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
 
-	// Endomorphism #1
-	// if (x, y) = k * G, then (beta*x, y) = lambda*k*G
-	pte1[0].x.ModMulK1(&p1.x, &beta);
-	pte1[0].y.Set(&p1.y);
-	pte1[1].x.ModMulK1(&p2.x, &beta);
-	pte1[1].y.Set(&p2.y);
-	pte1[2].x.ModMulK1(&p3.x, &beta);
-	pte1[2].y.Set(&p3.y);
-	pte1[3].x.ModMulK1(&p4.x, &beta);
-	pte1[3].y.Set(&p4.y);
-
-	secp->GetHash160(searchType, compressed, pte1[0], pte1[1], pte1[2], pte1[3], h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 1, compressed)) {
-			nbFoundKey++;
+	// Hash phase: point, endo #1, endo #2 then the symetric ones
+	for (int s = 0; s < 2; s++)
+		for (int e = 0; e < 3; e++)
+			secp->GetHash160(searchType, compressed, hb->x[e], hb->y[s], hb->odd[s], CPU_GRP_SIZE, hb->h[s * 3 + e]);
+
+	// Segwit mode: P2SH-P2WPKH script hashes are derived from the key hashes,
+	// P2WPKH uses the key hash itself. Only compressed keys are valid for segwit.
+	int nbType = (useSegwit && compressed) ? 2 : 1;
+	if (nbType > 1)
+		secp->GetHash160Script(hb->h[0], 6 * CPU_GRP_SIZE, hb->hs[0]);
+
+	// Filter phase, the 6 hash arrays of a type are checked as one batch
+	for (int t = 0; t < nbType; t++) {
+		int type = (t == 0) ? searchType : P2SH;
+		unsigned char* h = (t == 0) ? hb->h[0] : hb->hs[0];
+		if (addressMode == FILEMODE) {
+			CheckBloomBatch(h, 6 * CPU_GRP_SIZE, hb->hit);
 		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 1, compressed)) {
-			nbFoundKey++;
+		else {
+			for (int j = 0; j < 6 * CPU_GRP_SIZE; j++)
+				hb->hit[j] = MatchHash160((uint32_t*)(h + 20 * j)) ? 1 : 0;
+		}
+		for (int j = 0; j < 6 * CPU_GRP_SIZE; j++) {
+			if (hb->hit[j]) {
+				// Arrays are point, endo #1, endo #2 then the symetric ones
+				int s = j / (3 * CPU_GRP_SIZE);
+				int e = (j / CPU_GRP_SIZE) % 3;
+				int k = j % CPU_GRP_SIZE;
+				unsigned char* hj = h + 20 * j;
+				string addr = secp->GetAddress(type, compressed, hj);
+				if (checkPrivKey(addr, key, (s == 0) ? (i + k) : -(i + k), e, compressed, type)) {
+					nbFoundKey++;
+				}
+			}
 		}
 	}
 
-	// Endomorphism #2
-	// if (x, y) = k * G, then (beta2*x, y) = lambda2*k*G
-	pte2[0].x.ModMulK1(&p1.x, &beta2);
-	pte2[0].y.Set(&p1.y);
-	pte2[1].x.ModMulK1(&p2.x, &beta2);
-	pte2[1].y.Set(&p2.y);
-	pte2[2].x.ModMulK1(&p3.x, &beta2);
-	pte2[2].y.Set(&p3.y);
-	pte2[3].x.ModMulK1(&p4.x, &beta2);
-	pte2[3].y.Set(&p4.y);
-
-	secp->GetHash160(searchType, compressed, pte2[0], pte2[1], pte2[2], pte2[3], h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
+}
 
-	// Curve symetrie -------------------------------------------------------------------------
-	// if (x,y) = k*G, then (x, -y) is -k*G
+// ----------------------------------------------------------------------------
 
-	p1.y.ModNeg();
-	p2.y.ModNeg();
-	p3.y.ModNeg();
-	p4.y.ModNeg();
+// x point search: the x coordinate is checked directly, no hash. A point and
+// its symetric share x, so the 6 keys of a point only give 3 checks.
+void KeyHunt::checkXPoint(Int& key, int i, Point& p)
+{
 
-	secp->GetHash160(searchType, compressed, p1, p2, p3, p4, h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
+	unsigned char x[32];
+	Int xe[3];
 
+	xe[0].Set(&p.x);
 	// Endomorphism #1
-	// if (x, y) = k * G, then (beta*x, y) = lambda*k*G
-	pte1[0].y.ModNeg();
-	pte1[1].y.ModNeg();
-	pte1[2].y.ModNeg();
-	pte1[3].y.ModNeg();
-
-	secp->GetHash160(searchType, compressed, pte1[0], pte1[1], pte1[2], pte1[3], h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 1, compressed)) {
-			nbFoundKey++;
+	xe[1].ModMulK1(&p.x, &beta);
+	// Endomorphism #2
+	xe[2].ModMulK1(&p.x, &beta2);
+
+	for (int e = 0; e < 3; e++) {
+		xe[e].Get32Bytes(x);
+		bool hit = (addressMode == FILEMODE) ? (CheckBloomBinary(x) > 0) : MatchXPoint((uint32_t*)x);
+		if (hit) {
+			string addr = secp->GetAddress(XPOINT, true, x);
+			if (checkPrivKey(addr, key, i, e, true, XPOINT)) {
+				nbFoundKey++;
+			}
 		}
 	}
 
-	// Endomorphism #2
-	// if (x, y) = k * G, then (beta2*x, y) = lambda2*k*G
-	pte2[0].y.ModNeg();
-	pte2[1].y.ModNeg();
-	pte2[2].y.ModNeg();
-	pte2[3].y.ModNeg();
+}
+
+// ----------------------------------------------------------------------------
+void KeyHunt::getCPUStartingKey(int thId, Int & tRangeStart, Int & key, Point & startP)
+{
+	key.Set(&tRangeStart);
+	Int km(&key);
+	km.Add((uint64_t)CPU_GRP_SIZE / 2);
+	startP = secp->ComputePublicKey(&km);
 
-	secp->GetHash160(searchType, compressed, pte2[0], pte2[1], pte2[2], pte2[3], h0, h1, h2, h3);
-	if (CheckBloomBinary(h0) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h1) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h2) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (CheckBloomBinary(h3) > 0) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
 }
 
+void KeyHunt::getPipelineCpus(int thId, int& ecCpu, int& hashCpu)
+{
+	int nbPair = (int)pipelineCpus.size() / 2;
+	if (nbPair == 0) {
+		ecCpu = -1;
+		hashCpu = -1;
+		return;
+	}
+	ecCpu = pipelineCpus[2 * (thId % nbPair)];
+	hashCpu = pipelineCpus[2 * (thId % nbPair) + 1];
+}
 
-void KeyHunt::checkAddressesSSE2(bool compressed, Int key, int i, Point p1, Point p2, Point p3, Point p4)
+// ----------------------------------------------------------------------------
+
+void KeyHunt::checkGroup(Int& key, Point* pts, CPU_HASH_BATCH* hb)
 {
-	unsigned char h0[20];
-	unsigned char h1[20];
-	unsigned char h2[20];
-	unsigned char h3[20];
-	Point pte1[4];
-	Point pte2[4];
-
-	// Point -------------------------------------------------------------------------
-	secp->GetHash160(searchType, compressed, p1, p2, p3, p4, h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
 
-	// Endomorphism #1
-	// if (x, y) = k * G, then (beta*x, y) = lambda*k*G
-	pte1[0].x.ModMulK1(&p1.x, &beta);
-	pte1[0].y.Set(&p1.y);
-	pte1[1].x.ModMulK1(&p2.x, &beta);
-	pte1[1].y.Set(&p2.y);
-	pte1[2].x.ModMulK1(&p3.x, &beta);
-	pte1[2].y.Set(&p3.y);
-	pte1[3].x.ModMulK1(&p4.x, &beta);
-	pte1[3].y.Set(&p4.y);
-
-	secp->GetHash160(searchType, compressed, pte1[0], pte1[1], pte1[2], pte1[3], h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 1, compressed)) {
-			nbFoundKey++;
+	if (searchType == XPOINT) {
+
+		for (int i = 0; i < CPU_GRP_SIZE && !endOfSearch; i++)
+			checkXPoint(key, i, pts[i]);
+
+	}
+	else if (useSSE) {
+
+		// Generate phase: affine coordinates of the 6 keys of each point
+		for (int j = 0; j < CPU_GRP_SIZE; j++) {
+			Point& p = pts[j];
+			hb->x[0][j].Set(&p.x);
+			// Endomorphism #1
+			// if (x, y) = k * G, then (beta*x, y) = lambda*k*G
+			hb->x[1][j].ModMulK1(&p.x, &beta);
+			// Endomorphism #2
+			// if (x, y) = k * G, then (beta2*x, y) = lambda2*k*G
+			hb->x[2][j].ModMulK1(&p.x, &beta2);
+			// Curve symetrie
+			// if (x,y) = k*G, then (x, -y) is -k*G
+			hb->odd[0][j] = p.y.IsOdd();
+			hb->odd[1][j] = !hb->odd[0][j];
+			if (searchMode != SEARCH_COMPRESSED) {
+				hb->y[0][j].Set(&p.y);
+				hb->y[1][j].Set(&p.y);
+				hb->y[1][j].ModNeg();
+			}
 		}
-	}
 
-	// Endomorphism #2
-	// if (x, y) = k * G, then (beta2*x, y) = lambda2*k*G
-	pte2[0].x.ModMulK1(&p1.x, &beta2);
-	pte2[0].y.Set(&p1.y);
-	pte2[1].x.ModMulK1(&p2.x, &beta2);
-	pte2[1].y.Set(&p2.y);
-	pte2[2].x.ModMulK1(&p3.x, &beta2);
-	pte2[2].y.Set(&p3.y);
-	pte2[3].x.ModMulK1(&p4.x, &beta2);
-	pte2[3].y.Set(&p4.y);
-
-	secp->GetHash160(searchType, compressed, pte2[0], pte2[1], pte2[2], pte2[3], h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, i + 0, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, i + 1, 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, i + 2, 2, compressed)) {
-			nbFoundKey++;
+		switch (searchMode) {
+		case SEARCH_COMPRESSED:
+			checkBatch(true, key, 0, hb);
+			break;
+		case SEARCH_UNCOMPRESSED:
+			checkBatch(false, key, 0, hb);
+			break;
+		case SEARCH_BOTH:
+			checkBatch(true, key, 0, hb);
+			checkBatch(false, key, 0, hb);
+			break;
 		}
 	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, i + 3, 2, compressed)) {
-			nbFoundKey++;
+	else {
+
+		for (int i = 0; i < CPU_GRP_SIZE && !endOfSearch; i++) {
+
+			switch (searchMode) {
+			case SEARCH_COMPRESSED:
+				if (addressMode == FILEMODE)
+					checkAddresses(true, key, i, pts[i]);
+				else
+					checkAddresses2(true, key, i, pts[i]);
+				break;
+			case SEARCH_UNCOMPRESSED:
+				if (addressMode == FILEMODE)
+					checkAddresses(false, key, i, pts[i]);
+				else
+					checkAddresses(false, key, i, pts[i]);
+				break;
+			case SEARCH_BOTH:
+				if (addressMode == FILEMODE) {
+					checkAddresses(true, key, i, pts[i]);
+					checkAddresses(false, key, i, pts[i]);
+				}
+				else {
+					checkAddresses2(true, key, i, pts[i]);
+					checkAddresses2(false, key, i, pts[i]);
+				}
+				break;
+			}
 		}
 	}
 
-	// Curve symetrie -------------------------------------------------------------------------
-	// if (x,y) = k*G, then (x, -y) is -k*G
+}
 
-	p1.y.ModNeg();
-	p2.y.ModNeg();
-	p3.y.ModNeg();
-	p4.y.ModNeg();
+// ----------------------------------------------------------------------------
 
-	secp->GetHash160(searchType, compressed, p1, p2, p3, p4, h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 0, compressed)) {
-			nbFoundKey++;
-		}
-	}
+// Hash thread of the pipelined mode, drain groups produced by FindKeyCPU()
+void KeyHunt::CheckKeyCPU(TH_PARAM * ph)
+{
 
-	// Endomorphism #1
-	// if (x, y) = k * G, then (beta*x, y) = lambda*k*G
-	pte1[0].y.ModNeg();
-	pte1[1].y.ModNeg();
-	pte1[2].y.ModNeg();
-	pte1[3].y.ModNeg();
+	int thId = ph->threadId;
+	GroupRing* ring = ph->ring;
+	CPU_HASH_BATCH* hb = new CPU_HASH_BATCH;
+	int spin = 0;
 
-	secp->GetHash160(searchType, compressed, pte1[0], pte1[1], pte1[2], pte1[3], h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 1, compressed)) {
-			nbFoundKey++;
-		}
-	}
+	pinThread(ph->cpuId);
 
-	// Endomorphism #2
-	// if (x, y) = k * G, then (beta2*x, y) = lambda2*k*G
-	pte2[0].y.ModNeg();
-	pte2[1].y.ModNeg();
-	pte2[2].y.ModNeg();
-	pte2[3].y.ModNeg();
+	while (!endOfSearch) {
 
-	secp->GetHash160(searchType, compressed, pte2[0], pte2[1], pte2[2], pte2[3], h0, h1, h2, h3);
-	if (MatchHash160((uint32_t*)h0)) {
-		string addr = secp->GetAddress(searchType, compressed, h0);
-		if (checkPrivKey(addr, key, -(i + 0), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h1)) {
-		string addr = secp->GetAddress(searchType, compressed, h1);
-		if (checkPrivKey(addr, key, -(i + 1), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h2)) {
-		string addr = secp->GetAddress(searchType, compressed, h2);
-		if (checkPrivKey(addr, key, -(i + 2), 2, compressed)) {
-			nbFoundKey++;
-		}
-	}
-	if (MatchHash160((uint32_t*)h3)) {
-		string addr = secp->GetAddress(searchType, compressed, h3);
-		if (checkPrivKey(addr, key, -(i + 3), 2, compressed)) {
-			nbFoundKey++;
+		CPU_GROUP* g = ring->BeginRead();
+		if (g == NULL) {
+			if (ring->IsClosed() && ring->BeginRead() == NULL)
+				break;
+			waitSpin(spin);
+			continue;
 		}
+		spin = 0;
+
+		checkGroup(g->key, g->pts, hb);
+		ring->EndRead();
+
+		counters[thId] += 6 * CPU_GRP_SIZE; // Point + endo #1 + endo #2 + Symetric point + endo #1 + endo #2
 	}
-}
 
-// ----------------------------------------------------------------------------
-void KeyHunt::getCPUStartingKey(int thId, Int & tRangeStart, Int & key, Point & startP)
-{
-	key.Set(&tRangeStart);
-	Int km(&key);
-	km.Add((uint64_t)CPU_GRP_SIZE / 2);
-	startP = secp->ComputePublicKey(&km);
+	delete hb;
+	ph->isRunning = false;
 
 }
 
+// ----------------------------------------------------------------------------
+
 void KeyHunt::FindKeyCPU(TH_PARAM * ph)
 {
 
@@ -908,7 +1241,8 @@ void KeyHunt::FindKeyCPU(TH_PARAM * ph)
 	getCPUStartingKey(thId, tRangeStart, key, startP);
 
 	Int dx[CPU_GRP_SIZE / 2 + 1];
-	Point pts[CPU_GRP_SIZE];
+	Point groupPts[CPU_GRP_SIZE];
+	Point* pts = groupPts;
 
 	Int dy;
 	Int dyn;
@@ -918,10 +1252,60 @@ void KeyHunt::FindKeyCPU(TH_PARAM * ph)
 	Point pn;
 	grp->Set(dx);
 
+	// Pipelined mode, this thread only computes the groups and a
+	// hash thread running on the sibling CPU checks them
+	GroupRing* ring = NULL;
+	CPU_HASH_BATCH* hb = NULL;
+	TH_PARAM hashParam;
+#ifdef WIN64
+	HANDLE hashThread;
+#else
+	pthread_t hashThread;
+#endif
+
+	if (usePipeline) {
+
+		int ecCpu;
+		int hashCpu;
+		getPipelineCpus(thId, ecCpu, hashCpu);
+		pinThread(ecCpu);
+
+		ring = new GroupRing();
+		hashParam.obj = this;
+		hashParam.threadId = thId;
+		hashParam.isRunning = true;
+		hashParam.hasStarted = true;
+		hashParam.ring = ring;
+		hashParam.cpuId = hashCpu;
+
+#ifdef WIN64
+		DWORD thread_id;
+		hashThread = CreateThread(NULL, 0, _CheckKey, (void*)&hashParam, 0, &thread_id);
+#else
+		pthread_create(&hashThread, NULL, &_CheckKey, (void*)&hashParam);
+#endif
+
+	}
+	else {
+		hb = new CPU_HASH_BATCH;
+	}
+
 	ph->hasStarted = true;
 
 	while (!endOfSearch) {
 
+		if (ring) {
+			// Wait for a free slot and compute the group in place
+			int spin = 0;
+			CPU_GROUP* slot;
+			while ((slot = ring->BeginWrite()) == NULL && !endOfSearch)
+				waitSpin(spin);
+			if (slot == NULL)
+				break;
+			slot->key.Set(&key);
+			pts = slot->pts;
+		}
+
 		// Fill group
 		int i;
 		int hLength = (CPU_GRP_SIZE / 2 - 1);
@@ -1016,72 +1400,30 @@ void KeyHunt::FindKeyCPU(TH_PARAM * ph)
 		pp.y.ModSub(&_2Gn.y);
 		startP = pp;
 
-		// Check addresses
-		if (useSSE) {
-
-			for (int i = 0; i < CPU_GRP_SIZE && !endOfSearch; i += 4) {
-
-				switch (searchMode) {
-				case SEARCH_COMPRESSED:
-					if (addressMode == FILEMODE)
-						checkAddressesSSE(true, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-					else
-						checkAddressesSSE2(true, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-					break;
-				case SEARCH_UNCOMPRESSED:
-					if (addressMode == FILEMODE)
-						checkAddressesSSE(false, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-					else
-						checkAddressesSSE2(false, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-					break;
-				case SEARCH_BOTH:
-					if (addressMode == FILEMODE) {
-						checkAddressesSSE(true, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-						checkAddressesSSE(false, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-					}
-					else {
-						checkAddressesSSE2(true, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-						checkAddressesSSE2(false, key, i, pts[i], pts[i + 1], pts[i + 2], pts[i + 3]);
-
-					}
-					break;
-				}
-			}
+		if (ring) {
+			ring->EndWrite();
 		}
 		else {
-
-			for (int i = 0; i < CPU_GRP_SIZE && !endOfSearch; i++) {
-
-				switch (searchMode) {
-				case SEARCH_COMPRESSED:
-					if (addressMode == FILEMODE)
-						checkAddresses(true, key, i, pts[i]);
-					else
-						checkAddresses2(true, key, i, pts[i]);
-					break;
-				case SEARCH_UNCOMPRESSED:
-					if (addressMode == FILEMODE)
-						checkAddresses(false, key, i, pts[i]);
-					else
-						checkAddresses(false, key, i, pts[i]);
-					break;
-				case SEARCH_BOTH:
-					if (addressMode == FILEMODE) {
-						checkAddresses(true, key, i, pts[i]);
-						checkAddresses(false, key, i, pts[i]);
-					}
-					else {
-						checkAddresses2(true, key, i, pts[i]);
-						checkAddresses2(false, key, i, pts[i]);
-					}
-					break;
-				}
-			}
+			checkGroup(key, pts, hb);
+			counters[thId] += 6 * CPU_GRP_SIZE; // Point + endo #1 + endo #2 + Symetric point + endo #1 + endo #2
 		}
 
 		key.Add((uint64_t)CPU_GRP_SIZE);
-		counters[thId] += 6 * CPU_GRP_SIZE; // Point + endo #1 + endo #2 + Symetric point + endo #1 + endo #2
 	}
+
+	if (ring) {
+		ring->Close();
+#ifdef WIN64
+		WaitForSingleObject(hashThread, INFINITE);
+		CloseHandle(hashThread);
+#else
+		pthread_join(hashThread, NULL);
+#endif
+		delete ring;
+	}
+
+	delete hb;
+	delete grp;
 	ph->isRunning = false;
 }
 
@@ -1149,13 +1491,21 @@ void KeyHunt::FindKeyGPU(TH_PARAM * ph)
 
 	GPUEngine* g;
 
-	if (addressMode == FILEMODE) {
+	if (addressMode == FILEMODE && fuse) {
+		g = new GPUEngine(ph->gridSizeX, ph->gridSizeY, ph->gpuId, maxFound, BLOOM_N, 0,
+			3, fuse->get_format(), fuse->get_fp(), index, DATA_LEN);
+		g->SetFuseFilter(fuse->get_seed(), fuse->get_segment_length(), fuse->get_segment_count_length());
+	}
+	else if (addressMode == FILEMODE) {
+		// With a delta the hits are checked here, against the delta too
 		g = new GPUEngine(ph->gridSizeX, ph->gridSizeY, ph->gpuId, maxFound, BLOOM_N, bloom->get_bits(),
-			bloom->get_hashes(), bloom->get_bf(), DATA, TOTAL_ADDR);
+			bloom->get_hashes(), bloom->get_format(), bloom->get_bf(), (deltaFile.length() > 0) ? NULL : index, DATA_LEN);
 	}
 	else {
-		g = new GPUEngine(ph->gridSizeX, ph->gridSizeY, ph->gpuId, maxFound, hash160);
+		g = new GPUEngine(ph->gridSizeX, ph->gridSizeY, ph->gpuId, maxFound, set);
 	}
+	if (prefilter)
+		g->SetPreFilter(prefilter->get_table(), prefilter->get_bytes(), prefilter->get_shift());
 
 
 
@@ -1170,6 +1520,7 @@ void KeyHunt::FindKeyGPU(TH_PARAM * ph)
 
 	g->SetSearchMode(searchMode);
 	g->SetSearchType(searchType);
+	g->SetSegwit(useSegwit);
 	g->SetAddressMode(addressMode);
 
 	getGPUStartingKeys(thId, tRangeStart, tRangeEnd, g->GetGroupSize(), nbThread, keys, p);
@@ -1178,8 +1529,16 @@ void KeyHunt::FindKeyGPU(TH_PARAM * ph)
 	ph->hasStarted = true;
 
 	// GPU Thread
+	uint32_t pushedGeneration = 0;
 	while (ok && !endOfSearch) {
 
+		// Targets added since the last launch
+		uint32_t generation = deltaGeneration.load(std::memory_order_acquire);
+		if (generation != pushedGeneration) {
+			PushDelta(g);
+			pushedGeneration = generation;
+		}
+
 		// Call kernel
 		if (addressMode == FILEMODE) {
 			ok = g->Launch(found, false);
@@ -1190,10 +1549,12 @@ void KeyHunt::FindKeyGPU(TH_PARAM * ph)
 		for (int i = 0; i < (int)found.size() && !endOfSearch; i++) {
 
 			ITEM it = found[i];
+			if (deltaFile.length() > 0 && !CheckTarget(it.hash))
+				continue;
 			//checkAddr(it.hash, keys[it.thId], it.incr, it.endo, it.mode);
-			string addr = secp->GetAddress(searchType, it.mode, it.hash);
+			string addr = secp->GetAddress(it.type, it.mode, it.hash);
 
-			if (checkPrivKey(addr, keys[it.thId], it.incr, it.endo, it.mode)) {
+			if (checkPrivKey(addr, keys[it.thId], it.incr, it.endo, it.mode, it.type)) {
 				nbFoundKey++;
 			}
 
@@ -1309,6 +1670,16 @@ void KeyHunt::Search(int nbThread, std::vector<int> gpuId, std::vector<int> grid
 	int rangeShowThreasold = 3;
 	int rangeShowCounter = 0;
 
+	if (usePipeline && nbCPUThread > 0) {
+		getSMTPairs(pipelineCpus);
+		int ecCpu;
+		int hashCpu;
+		for (int i = 0; i < nbCPUThread && i < rangeShowThreasold; i++) {
+			getPipelineCpus(i, ecCpu, hashCpu);
+			printf("CPU Thread %02d: EC on cpu %d, hash on cpu %d\n", i, ecCpu, hashCpu);
+		}
+	}
+
 	// Launch CPU threads
 	for (int i = 0; i < nbCPUThread; i++) {
 		params[i].obj = this;
@@ -1438,6 +1809,9 @@ void KeyHunt::Search(int nbThread, std::vector<int> gpuId, std::vector<int> grid
 				nbFoundKey);
 		}
 
+		if (deltaFile.length() > 0)
+			ReloadDelta(params, nbCPUThread + nbGPUThread);
+
 		lastCount = count;
 		lastGPUCount = gpuCount;
 		t0 = t1;
@@ -1468,49 +1842,81 @@ string KeyHunt::GetHex(vector<unsigned char> &buffer)
 
 int KeyHunt::CheckBloomBinary(const uint8_t * hash)
 {
-	if (bloom->check(hash, 20) > 0) {
-		uint8_t* temp_read;
-		uint64_t half, min, max, current; //, current_offset
-		int64_t rcmp;
-		int32_t r = 0;
-		min = 0;
-		current = 0;
-		max = TOTAL_ADDR;
-		half = TOTAL_ADDR;
-		while (!r && half >= 1) {
-			half = (max - min) / 2;
-			temp_read = DATA + ((current + half) * 20);
-			rcmp = memcmp(hash, temp_read, 20);
-			if (rcmp == 0) {
-				r = 1;  //Found!!
-			}
-			else {
-				if (rcmp < 0) { //data < temp_read
-					max = (max - half);
-				}
-				else { // data > temp_read
-					min = (min + half);
-				}
-				current = min;
+	if (prefilter && !prefilter->check(hash))
+		return 0;
+
+	if (tree)
+		return tree->find(hash) ? 1 : 0;
+
+	int hit = fuse ? fuse->check(hash, DATA_LEN) : bloom->check(hash, DATA_LEN);
+	if (hit > 0)
+		return CheckTarget(hash) ? 1 : 0;
+	return 0;
+}
+
+// Exact check of a filter hit: in the target file and not removed since, or
+// added during the search
+bool KeyHunt::CheckTarget(const uint8_t * hash)
+{
+	TargetDelta* d = delta.load(std::memory_order_acquire);
+	if (d == NULL)
+		return index->find(hash);
+	return index->find(hash) ? !d->removed(hash) : d->added(hash);
+}
+
+// Membership test of n consecutive hashes, same result as CheckBloomBinary().
+// The filter lines of a key are prefetched CPU_PREFETCH_DISTANCE keys ahead of
+// its check and the index of a filter hit before the exact checks, which come
+// last: the cache misses of several keys overlap instead of being waited one
+// by one.
+void KeyHunt::CheckBloomBatch(const uint8_t * hash, int n, uint8_t * hit)
+{
+	// Exact tree, its descent is batched by TargetTree::find_batch()
+	if (tree) {
+		for (int i = 0; i < n; i++)
+			hit[i] = (prefilter == NULL || prefilter->check(hash + i * DATA_LEN)) ? 1 : 0;
+		tree->find_batch(hash, n, hit);
+		return;
+	}
+
+	for (int i = 0; i < n + CPU_PREFETCH_DISTANCE; i++) {
+
+		// Prefilter (L2 resident) and prefetch of the filter
+		if (i < n) {
+			const uint8_t* h = hash + i * DATA_LEN;
+			hit[i] = (prefilter == NULL || prefilter->check(h)) ? 1 : 0;
+			if (hit[i]) {
+				if (fuse)
+					fuse->prefetch(h, DATA_LEN);
+				else
+					bloom->prefetch(h, DATA_LEN);
 			}
 		}
-		return r;
+
+		// Filter check of the key prefetched CPU_PREFETCH_DISTANCE keys ago
+		int j = i - CPU_PREFETCH_DISTANCE;
+		if (j >= 0 && hit[j]) {
+			const uint8_t* h = hash + j * DATA_LEN;
+			hit[j] = ((fuse ? fuse->check(h, DATA_LEN) : bloom->check(h, DATA_LEN)) > 0) ? 1 : 0;
+			if (hit[j])
+				index->prefetch(h);
+		}
+
 	}
-	return 0;
+
+	for (int i = 0; i < n; i++)
+		if (hit[i])
+			hit[i] = CheckTarget(hash + i * DATA_LEN) ? 1 : 0;
 }
 
 bool KeyHunt::MatchHash160(uint32_t * _h)
 {
-	if (_h[0] == hash160[0] &&
-		_h[1] == hash160[1] &&
-		_h[2] == hash160[2] &&
-		_h[3] == hash160[3] &&
-		_h[4] == hash160[4]) {
-		return true;
-	}
-	else {
-		return false;
-	}
+	return set->find(_h);
+}
+
+bool KeyHunt::MatchXPoint(uint32_t * _x)
+{
+	return set->find(_x);
 }
 
 std::string KeyHunt::formatThousands(uint64_t x)
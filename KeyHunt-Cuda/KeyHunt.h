@@ -3,8 +3,16 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 #include "SECP256k1.h"
 #include "Bloom.h"
+#include "FuseFilter.h"
+#include "TargetIndex.h"
+#include "TargetTree.h"
+#include "FilterCache.h"
+#include "PreFilter.h"
+#include "TargetSet.h"
+#include "TargetDelta.h"
 #include "GPU/GPUEngine.h"
 #ifdef WIN64
 #include <Windows.h>
@@ -12,8 +20,62 @@
 
 #define CPU_GRP_SIZE 1024
 
+// Keys between the prefetch of the filter lines of a key and its check
+// (CheckBloomBatch), enough misses in flight to cover the memory latency
+#define CPU_PREFETCH_DISTANCE 16
+
+// Number of point groups in flight between the EC and the hash thread (pipelined mode)
+#define CPU_RING_SIZE 4
+
 class KeyHunt;
 
+typedef struct {
+
+	Int  key;
+	Point pts[CPU_GRP_SIZE];
+
+} CPU_GROUP;
+
+// Per thread scratch of the phased CPU check (generate, hash, filter),
+// one CPU_GRP_SIZE group of points is processed at a time
+typedef struct {
+
+	Int x[3][CPU_GRP_SIZE];            // x, beta*x, beta2*x
+	Int y[2][CPU_GRP_SIZE];            // y, -y (uncompressed keys only)
+	uint8_t odd[2][CPU_GRP_SIZE];      // parity of y and -y
+	uint8_t h[6][CPU_GRP_SIZE * 20];   // hash160 of the 6 keys of each point
+	uint8_t hs[6][CPU_GRP_SIZE * 20];  // hash160 of their P2SH-P2WPKH script (segwit mode)
+	uint8_t hit[6 * CPU_GRP_SIZE];     // result of the filter phase for one of h or hs
+
+} CPU_HASH_BATCH;
+
+// Lock-free single-producer/single-consumer ring of point groups.
+// The EC thread fills slots in place and the hash thread drains them in order.
+class GroupRing
+{
+
+public:
+
+	GroupRing();
+	~GroupRing();
+
+	CPU_GROUP* BeginWrite();
+	void EndWrite();
+	CPU_GROUP* BeginRead();
+	void EndRead();
+
+	void Close();
+	bool IsClosed();
+
+private:
+
+	CPU_GROUP* slots;
+	alignas(64) std::atomic<uint32_t> head;
+	alignas(64) std::atomic<uint32_t> tail;
+	alignas(64) std::atomic<bool> closed;
+
+};
+
 typedef struct {
 
 	KeyHunt* obj;
@@ -29,8 +91,22 @@ typedef struct {
 	Int rangeEnd;
 	//Int rangeDiff;
 
+	GroupRing* ring;
+	int  cpuId;
+
 } TH_PARAM;
 
+// Slice of the target array added to the Bloom filter by a loading thread
+typedef struct {
+
+	KeyHunt* obj;
+	int  threadId;
+	uint64_t start;
+	uint64_t end;
+	bool concurrent;
+
+} FILTER_PARAM;
+
 
 class KeyHunt
 {
@@ -38,23 +114,35 @@ class KeyHunt
 public:
 
 	KeyHunt(const std::string& addressFile, const std::vector<unsigned char>& addressHash, 
-		int searchMode, bool useGpu, const std::string& outputFile, bool useSSE, uint32_t maxFound,
+		int searchType, int searchMode, bool useSegwit, int filterFormat, int compactLen, const std::string& deltaFile,
+		bool useGpu, const std::string& outputFile, bool useSSE, bool usePipeline, uint32_t maxFound,
 		const std::string& rangeStart, const std::string& rangeEnd, bool& should_exit);
 	~KeyHunt();
 
 	void Search(int nbThread, std::vector<int> gpuId, std::vector<int> gridSize, bool& should_exit);
 	void FindKeyCPU(TH_PARAM* p);
+	void CheckKeyCPU(TH_PARAM* p);
 	void FindKeyGPU(TH_PARAM* p);
+	void BuildFilter(FILTER_PARAM* p);
 
 private:
 
 	std::string GetHex(std::vector<unsigned char>& buffer);
-	bool checkPrivKey(std::string addr, Int& key, int32_t incr, int endomorphism, bool mode);
+	uint64_t MapTargets();
+	void UnmapTargets();
+	bool LoadCache(uint64_t N, int filterFormat);
+	void SaveCache();
+	void ReloadDelta(TH_PARAM* params, int nbThread);
+#ifdef WITHGPU
+	void PushDelta(GPUEngine* g);
+#endif
+	bool checkPrivKey(std::string addr, Int& key, int32_t incr, int endomorphism, bool mode, int type);
 	void checkAddresses(bool compressed, Int key, int i, Point p1);
 	void checkAddresses2(bool compressed, Int key, int i, Point p1);
-	void checkAddressesSSE(bool compressed, Int key, int i, Point p1, Point p2, Point p3, Point p4);
-	void checkAddressesSSE2(bool compressed, Int key, int i, Point p1, Point p2, Point p3, Point p4);
-	void output(std::string addr, std::string pAddr, std::string pAddrHex);
+	void checkBatch(bool compressed, Int& key, int i, CPU_HASH_BATCH* hb);
+	void checkXPoint(Int& key, int i, Point& p);
+	void checkGroup(Int& key, Point* pts, CPU_HASH_BATCH* hb);
+	void output(std::string addr, std::string pAddr, std::string pAddrHex, int type);
 	bool isAlive(TH_PARAM* p);
 
 	bool hasStarted(TH_PARAM* p);
@@ -63,15 +151,34 @@ private:
 	void SetupRanges(uint32_t totalThreads);
 
 	void getCPUStartingKey(int thId, Int &tRangeStart, Int& key, Point& startP);
+	void getPipelineCpus(int thId, int& ecCpu, int& hashCpu);
 	void getGPUStartingKeys(int thId, Int& tRangeStart, Int& tRangeEnd, int groupSize, int nbThread, Int* keys, Point* p);
 
 	int CheckBloomBinary(const uint8_t* hash);
+	void CheckBloomBatch(const uint8_t* hash, int n, uint8_t* hit);
+	bool CheckTarget(const uint8_t* hash);
 	bool MatchHash160(uint32_t* _h);
+	bool MatchXPoint(uint32_t* _x);
 	std::string formatThousands(uint64_t x);
 	char* toTimeStr(int sec, char* timeStr);
 
 	Secp256K1* secp;
 	Bloom* bloom;
+	FuseFilter* fuse;      // replaces the Bloom filter with FILTER_FUSE8/16
+	TargetIndex* index;    // exact check of the filter hits
+	TargetTree* tree;      // exact lookup without filter (FILTER_TREE, CPU only)
+	FilterCache* cache;    // mapping of the saved filter and index, used in place
+	PreFilter* prefilter;  // L2 resident first level filter, NULL for large target sets
+	TargetSet* set;        // targets given with -a (SINGLEMODE)
+
+	// Targets added or removed during the search (-d), the delta is replaced
+	// when its file changes while the threads keep running
+	std::string deltaFile;
+	std::atomic<TargetDelta*> delta;
+	std::atomic<uint32_t> deltaGeneration;  // reloads, the GPU threads push the additions on change
+	TargetDelta* retiredDelta;              // freed once every running thread went through a group
+	uint64_t retiredCounters[256];
+	uint64_t deltaTime;                     // modification time of the loaded delta file
 
 	uint64_t counters[256];
 	double startTime;
@@ -79,6 +186,7 @@ private:
 	int searchMode;
 	int searchType;
 	int addressMode;
+	bool useSegwit;
 
 	bool useGpu;
 	bool endOfSearch;
@@ -89,8 +197,9 @@ private:
 	std::string outputFile;
 	std::string addressFile;
 	//std::string addressHash;
-	uint32_t hash160[5];
 	bool useSSE;
+	bool usePipeline;
+	std::vector<int> pipelineCpus;
 
 	Int rangeStart;
 	Int rangeEnd;
@@ -98,8 +207,17 @@ private:
 
 	uint32_t maxFound;
 
-	uint8_t* DATA;
+	uint8_t* DATA;         // read-only mapping of the target file
+	uint8_t* PREFIX;       // first compactLen bytes of the targets (compact store)
+	int compactLen;        // 0 when the full records are kept
+	uint64_t DATA_SIZE;
+	uint32_t DATA_LEN;     // 20 (hash160) or 32 (x coordinate)
 	uint64_t TOTAL_ADDR;
+	bool* shouldExit;
+#ifdef WIN64
+	HANDLE dataFile;
+	HANDLE dataMapping;
+#endif
 	uint64_t BLOOM_N;
 
 	Int beta;
@@ -1,7 +1,10 @@
 #include "Timer.h"
 #include "KeyHunt.h"
 #include "Base58.h"
+#include "Bech32.h"
 #include "ArgParse.h"
+#include "TargetMerge.h"
+#include "hash/cpuid.h"
 #include <fstream>
 #include <string>
 #include <string.h>
@@ -25,6 +28,8 @@ const char* vstr = "Print version
 const char* cstr = "Check the working of the codes                                                                  ";
 const char* ustr = "Search uncompressed addresses                                                                   ";
 const char* bstr = "Search both uncompressed or compressed addresses                                                ";
+const char* wstr = "Segwit: Also search P2SH-P2WPKH (3...) and P2WPKH (bc1q...) addresses of compressed keys        ";
+const char* kstr = "X point: Search public keys, file holds sorted 32 bytes x coordinates, no hashing               ";
 const char* gstr = "Enable GPU calculation                                                                          ";
 const char* istr = "GPU ids: 0,1...: List of GPU(s) to use, default is 0                                            ";
 const char* xstr = "GPU gridsize: g0x,g0y,g1x,g1y, ...: Specify GPU(s) kernel gridsize, default is 8*(Device MP count),128";
@@ -34,10 +39,15 @@ const char* mstr = "Specify maximun number of addresses found by each kernel cal
 const char* tstr = "threadNumber: Specify number of CPU thread, default is number of core                           ";
 //const char* estr = "Disable SSE hash function                                                                       ";
 const char* lstr = "List cuda enabled devices                                                                       ";
+const char* ppstr = "Pipelined CPU mode: EC and hash stages run in separate threads pinned on SMT siblings           ";
 //const char* rstr = "Rkey: Rekey interval in MegaKey, default is disabled                                            ";
 //const char* nstr = "Number of base key random bits                                                                  ";
+const char* ystr = "Filter: bloom, blocked (1 cache line per lookup), fuse8, fuse16 (binary fuse) or tree (exact)   ";
+const char* zstr = "Compact: keep only the first n bytes (4-16) of each target in memory, hits are read from file   ";
+const char* dstr = "Delta: text file of hex targets to add (+) or remove (-), reloaded when it changes              ";
+const char* jstr = "Merge: add (+) and remove (-) the targets of a delta file in the -f file and caches, then exit  ";
 const char* fstr = "Ripemd160 binary hash file path                                                                 ";
-const char* astr = "P2PKH Address (single address mode)                                                             ";
+const char* astr = "P2PKH, P2SH-P2WPKH, P2WPKH Address or hex public key, or a comma separated list of up to 4096   ";
 
 const char* pstr = "Range start in hex                                                                              ";
 const char* qstr = "Range end in hex, if not provided then, endRange would be: startRange + 10000000000000000       ";
@@ -73,6 +83,20 @@ void getInts(string name, vector<int>& tokens, const string& text, char sep)
 
 }
 
+void getStrings(vector<string>& tokens, const string& text, char sep)
+{
+
+	size_t start = 0, end = 0;
+	tokens.clear();
+
+	while ((end = text.find(sep, start)) != string::npos) {
+		tokens.push_back(text.substr(start, end - start));
+		start = end + 1;
+	}
+	tokens.push_back(text.substr(start));
+
+}
+
 #ifdef WIN64
 BOOL WINAPI CtrlHandler(DWORD fdwCtrlType)
 {
@@ -102,12 +126,15 @@ int main(int argc, const char* argv[])
 	bool gpuEnable = false;
 	bool gpuAutoGrid = true;
 	int searchMode = SEARCH_COMPRESSED;
+	bool segwit = false;
+	int searchType = P2PKH;
 	vector<int> gpuId = { 0 };
 	vector<int> gridSize;
 	//string seed = "";
 	string outputFile = "Found.txt";
 	string hash160File = "";
 	string address = "";
+	int nbAddress = 0;
 	//string hash160 = "";
 	std::vector<unsigned char> hash160;
 	bool singleAddress = false;
@@ -115,6 +142,11 @@ int main(int argc, const char* argv[])
 	//int nbit = 0;
 	bool tSpecified = false;
 	bool sse = true;
+	bool pipeline = false;
+	int bloomFormat = BLOOM_CLASSIC | BLOOM_DIRECT;
+	int compactLen = 0;
+	string deltaFile = "";
+	const char* filterNames[] = { "BLOOM", "BLOCKED BLOOM", "BINARY FUSE (8 BITS)", "BINARY FUSE (16 BITS)", "S+ TREE (EXACT)" };
 	uint32_t maxFound = 1024 * 64;
 	//uint64_t rekey = 0;
 	//bool paranoiacSeed = false;
@@ -128,6 +160,8 @@ int main(int argc, const char* argv[])
 	parser.add_argument("-c", "--check", cstr, false);
 	parser.add_argument("-u", "--uncomp", ustr, false);
 	parser.add_argument("-b", "--both", bstr, false);
+	parser.add_argument("-w", "--segwit", wstr, false);
+	parser.add_argument("-k", "--xpoint", kstr, false);
 	parser.add_argument("-g", "--gpu", gstr, false);
 	parser.add_argument("-i", "--gpui", istr, false);
 	parser.add_argument("-x", "--gpux", xstr, false);
@@ -136,9 +170,14 @@ int main(int argc, const char* argv[])
 	parser.add_argument("-t", "--thread", tstr, false);
 	//parser.add_argument("-e", "--nosse", estr, false);
 	parser.add_argument("-l", "--list", lstr, false);
+	parser.add_argument("-p", "--pipeline", ppstr, false);
 	//parser.add_argument("-r", "--rkey", rstr, false);
 	//parser.add_argument("-n", "--nbit", nstr, false);
+	parser.add_argument("-y", "--filter", ystr, false);
+	parser.add_argument("-z", "--compact", zstr, false);
 	parser.add_argument("-f", "--file", fstr, false);
+	parser.add_argument("-d", "--delta", dstr, false);
+	parser.add_argument("-j", "--merge", jstr, false);
 	parser.add_argument("-a", "--addr", astr, false);
 
 	parser.add_argument("-s", "--start", pstr, false);
@@ -186,6 +225,12 @@ int main(int argc, const char* argv[])
 	if (parser.exists("both")) {
 		searchMode = SEARCH_BOTH;
 	}
+	if (parser.exists("segwit")) {
+		segwit = true;
+	}
+	if (parser.exists("xpoint")) {
+		searchType = XPOINT;
+	}
 
 	if (parser.exists("gpu")) {
 		gpuEnable = true;
@@ -225,6 +270,45 @@ int main(int argc, const char* argv[])
 	//	sse = false;
 	//}
 
+	if (parser.exists("pipeline")) {
+		pipeline = true;
+	}
+
+	if (parser.exists("filter")) {
+		string filter = parser.get<string>("y");
+		if (filter == "bloom") {
+			bloomFormat = BLOOM_CLASSIC | BLOOM_DIRECT;
+		}
+		else if (filter == "blocked") {
+			bloomFormat = BLOOM_BLOCKED | BLOOM_DIRECT;
+		}
+		else if (filter == "fuse8") {
+			bloomFormat = FILTER_FUSE8;
+		}
+		else if (filter == "fuse16") {
+			bloomFormat = FILTER_FUSE16;
+		}
+		else if (filter == "tree") {
+			bloomFormat = FILTER_TREE;
+		}
+		else {
+			printf("Invalid filter argument, must be bloom, blocked, fuse8, fuse16 or tree\n");
+			exit(-1);
+		}
+	}
+
+	if (parser.exists("compact")) {
+		compactLen = parser.get<int>("z");
+		if (compactLen < 4 || compactLen > 16) {
+			printf("Invalid compact argument, must be in range: 4 - 16\n");
+			exit(-1);
+		}
+		if (bloomFormat == FILTER_TREE) {
+			printf("Invalid arguments, the tree keeps its own prefixes, compact can't be used with it\n");
+			exit(-1);
+		}
+	}
+
 	if (parser.exists("list")) {
 #ifdef WIN64
 		GPUEngine::PrintCudaInfo();
@@ -250,19 +334,72 @@ int main(int argc, const char* argv[])
 		hash160File = parser.get<string>("f");
 	}
 
+	if (parser.exists("delta")) {
+		deltaFile = parser.get<string>("d");
+	}
+
 	if (parser.exists("addr")) {
 		address = parser.get<string>("a");
-		if (address.length() < 30 || address[0] != '1') {
-			printf("Invalid addr argument, must have P2PKH address only\n");
+		vector<string> addresses;
+		getStrings(addresses, address, ',');
+		if (addresses.size() > SET_MAX_TARGETS) {
+			printf("Invalid addr argument, at most %d addresses\n", SET_MAX_TARGETS);
 			exit(-1);
 		}
-		else {
-			if (DecodeBase58(address, hash160)) {
-				hash160.erase(hash160.begin() + 0);
-				hash160.erase(hash160.begin() + 20, hash160.begin() + 24);
-				assert(hash160.size() == 20);
+		for (int i = 0; i < (int)addresses.size(); i++) {
+			string a = addresses.at(i);
+			std::vector<unsigned char> target;
+			bool isPub = (a.length() == 66 || a.length() == 130) && a[0] == '0';
+			if (!isPub && searchType == XPOINT && i == 0) {
+				printf("Invalid arguments, xpoint searches public keys, addr has an address\n");
+				exit(-1);
+			}
+			if (i > 0 && isPub != (searchType == XPOINT)) {
+				printf("Invalid addr argument, addresses and public keys can't be mixed\n");
+				exit(-1);
+			}
+			if (isPub) {
+				// Public key, only its x coordinate is searched
+				Secp256K1 sec;
+				sec.Init();
+				bool isComp;
+				Point pub = sec.ParsePublicKeyHex(a, isComp);
+				target.resize(32);
+				pub.x.Get32Bytes(target.data());
+				searchType = XPOINT;
+			}
+			else if (a.length() >= 30 && (a[0] == '1' || a[0] == '3')) {
+				if (!DecodeBase58(a, target) || target.size() != 25) {
+					printf("Invalid addr argument, bad address %s\n", a.c_str());
+					exit(-1);
+				}
+				target.erase(target.begin() + 0);
+				target.erase(target.begin() + 20, target.begin() + 24);
+				assert(target.size() == 20);
+				// Segwit addresses are only reported in segwit mode
+				if (a[0] == '3')
+					segwit = true;
+			}
+			else if (a.compare(0, 4, "bc1q") == 0) {
+				// P2WPKH witness program is the key hash
+				int witver;
+				uint8_t prog[40];
+				size_t progLen;
+				if (!segwit_addr_decode(&witver, prog, &progLen, "bc", a.c_str()) || witver != 0 || progLen != 20) {
+					printf("Invalid addr argument, bad P2WPKH address\n");
+					exit(-1);
+				}
+				target.assign(prog, prog + 20);
+				segwit = true;
+			}
+			else {
+				printf("Invalid addr argument, must have P2PKH, P2SH-P2WPKH or P2WPKH address only\n");
+				exit(-1);
 			}
+			// The targets are concatenated, KeyHunt builds its target set from them
+			hash160.insert(hash160.end(), target.begin(), target.end());
 		}
+		nbAddress = (int)addresses.size();
 	}
 
 	if (parser.exists("start")) {
@@ -295,6 +432,36 @@ int main(int argc, const char* argv[])
 		exit(-1);
 	}
 
+	if (searchType == XPOINT && segwit) {
+		printf("Invalid arguments, xpoint and segwit, both option can't be used together\n");
+		exit(-1);
+	}
+
+	// Merge tool, no search
+	if (parser.exists("merge")) {
+		if (hash160File.length() <= 0) {
+			printf("Invalid arguments, merge needs a target file\n");
+			exit(-1);
+		}
+		bool ok = MergeTargets(hash160File, parser.get<string>("j"), (searchType == XPOINT) ? 32 : 20, Timer::getCoreNumber());
+		return ok ? 0 : -1;
+	}
+
+	if (deltaFile.length() > 0 && hash160File.length() <= 0) {
+		printf("Invalid arguments, delta needs a target file\n");
+		exit(-1);
+	}
+
+	if (deltaFile.length() > 0 && BLOOM_LAYOUT(bloomFormat) > BLOOM_BLOCKED) {
+		printf("Invalid arguments, delta adds targets to a bloom filter, use -y bloom or blocked\n");
+		exit(-1);
+	}
+
+	if (bloomFormat == FILTER_TREE && gpuEnable) {
+		printf("Invalid arguments, the tree filter is CPU only\n");
+		exit(-1);
+	}
+
 	if (rangeStart.length() <= 0) {
 		printf("Invalid rangeStart argument, please provide start range at least, endRange would be: startRange + 10000000000000000\n");
 		exit(-1);
@@ -317,11 +484,19 @@ int main(int argc, const char* argv[])
 	if (nbCPUThread < 0)
 		nbCPUThread = 0;
 
+	// In pipelined mode each CPU thread is a pair of threads
+	if (pipeline && !tSpecified && nbCPUThread > 1)
+		nbCPUThread /= 2;
+
 	{
 		printf("\n");
 		printf("KeyHunt-Cuda v" RELEASE "\n");
 		printf("\n");
 		printf("MODE         : %s\n", searchMode == SEARCH_COMPRESSED ? "COMPRESSED" : (searchMode == SEARCH_UNCOMPRESSED ? "UNCOMPRESSED" : "COMPRESSED & UNCOMPRESSED"));
+		if (searchType == XPOINT)
+			printf("ADDR TYPES   : X POINT (public key)\n");
+		else
+			printf("ADDR TYPES   : %s\n", segwit ? "P2PKH, P2WPKH & P2SH-P2WPKH (compressed keys)" : "P2PKH");
 		printf("DEVICE       : %s\n", (gpuEnable && nbCPUThread > 0) ? "CPU & GPU" : ((!gpuEnable && nbCPUThread > 0) ? "CPU" : "GPU"));
 		printf("CPU THREAD   : %d\n", nbCPUThread);
 		printf("GPU IDS      : ");
@@ -348,18 +523,35 @@ int main(int argc, const char* argv[])
 			printf(" (grid size will be calculated automatically based on multiprocessor number on GPU device)\n");
 		else
 			printf("\n");
-		printf("SSE          : %s\n", sse ? "YES" : "NO");
+		if (sse) {
+			string simd = cpu_has_avx512() ? "AVX-512" : (cpu_has_avx2() ? "AVX2" : "SSE");
+			if (cpu_has_sha())
+				simd += ", SHA-NI";
+			printf("SSE          : YES (%s)\n", simd.c_str());
+		}
+		else {
+			printf("SSE          : NO\n");
+		}
+		printf("PIPELINE     : %s\n", pipeline ? "YES" : "NO");
 		printf("MAX FOUND    : %d\n", maxFound);
-		if (hash160File.length() > 0)
-			printf("HASH160 FILE : %s\n", hash160File.c_str());
+		if (hash160File.length() > 0) {
+			printf("FILTER       : %s\n", filterNames[BLOOM_LAYOUT(bloomFormat)]);
+			if (compactLen > 0)
+				printf("COMPACT      : %d bytes prefixes\n", compactLen);
+			printf("%s : %s\n", (searchType == XPOINT) ? "XPOINT FILE " : "HASH160 FILE", hash160File.c_str());
+			if (deltaFile.length() > 0)
+				printf("DELTA FILE   : %s\n", deltaFile.c_str());
+		}
+		else if (nbAddress > 1)
+			printf("ADDRESSES    : %d (small set mode)\n", nbAddress);
 		else
 			printf("ADDRESS      : %s (single address mode)\n", address.c_str());
 		printf("OUTPUT FILE  : %s\n", outputFile.c_str());
 	}
 #ifdef WIN64
 	if (SetConsoleCtrlHandler(CtrlHandler, TRUE)) {
-		KeyHunt* v = new KeyHunt(hash160File, hash160, searchMode, gpuEnable,
-			outputFile, sse, maxFound, rangeStart, rangeEnd, should_exit);
+		KeyHunt* v = new KeyHunt(hash160File, hash160, searchType, searchMode, segwit, bloomFormat, compactLen, deltaFile, gpuEnable,
+			outputFile, sse, pipeline, maxFound, rangeStart, rangeEnd, should_exit);
 
 		v->Search(nbCPUThread, gpuId, gridSize, should_exit);
 
@@ -373,8 +565,8 @@ int main(int argc, const char* argv[])
 	}
 #else
 	signal(SIGINT, CtrlHandler);
-	KeyHunt* v = new KeyHunt(hash160File, hash160, searchMode, gpuEnable,
-		outputFile, sse, maxFound, rangeStart, rangeEnd, should_exit);
+	KeyHunt* v = new KeyHunt(hash160File, hash160, searchType, searchMode, segwit, bloomFormat, compactLen, deltaFile, gpuEnable,
+		outputFile, sse, pipeline, maxFound, rangeStart, rangeEnd, should_exit);
 
 	v->Search(nbCPUThread, gpuId, gridSize, should_exit);
 
@@ -0,0 +1,81 @@
+#include "PreFilter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <emmintrin.h>
+
+PreFilter::PreFilter(const uint8_t *data, uint64_t count, int len)
+{
+    _count = count;
+
+    // About 8 bits per target (1/8 pass rate), capped to stay cache resident
+    _bits = PREFILTER_MIN_BITS;
+    while (_bits < PREFILTER_MAX_BITS && (1ULL << _bits) < 8 * count)
+        _bits++;
+    _shift = 32 - _bits;
+
+    uint64_t bytes = (1ULL << _bits) / 8;
+    _table = (uint8_t *)_mm_malloc((size_t)bytes, 64);
+    if (_table == NULL) {
+        printf("Prefilter init error\n");
+        exit(1);
+    }
+    memset(_table, 0, (size_t)bytes);
+
+    _set = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint32_t w;
+        memcpy(&w, data + i * len + PREFILTER_OFFSET, 4);
+        w >>= _shift;
+        uint8_t mask = (uint8_t)(1 << (w & 7));
+        if (!(_table[w >> 3] & mask)) {
+            _table[w >> 3] |= mask;
+            _set++;
+        }
+    }
+}
+
+PreFilter::~PreFilter()
+{
+    _mm_free(_table);
+}
+
+// Single writer, the readers see the bit set or not yet
+void PreFilter::add(const void *key)
+{
+    uint32_t w;
+    memcpy(&w, (const uint8_t *)key + PREFILTER_OFFSET, 4);
+    w >>= _shift;
+    uint8_t mask = (uint8_t)(1 << (w & 7));
+    if (!(_table[w >> 3] & mask)) {
+        _table[w >> 3] |= mask;
+        _set++;
+    }
+}
+
+bool PreFilter::useful(uint64_t count)
+{
+    // Expected fill 1 - exp(-count / 2^bits), one half at count = 2^bits * ln(2)
+    return (double)count <= (double)(1ULL << PREFILTER_MAX_BITS) * 0.693147180559945;
+}
+
+void PreFilter::print()
+{
+    printf("Prefilter at %p\n", (void *)this);
+    printf("  Bits       : 2^%d\n", _bits);
+    printf("  Pass rate  : %.4f\n", (double)_set / (double)(1ULL << _bits));
+    printf("  Bytes      : %llu", get_bytes());
+    printf(" (%llu KB)\n", get_bytes() / 1024);
+}
+
+int PreFilter::get_shift()
+{
+    return _shift;
+}
+const uint8_t *PreFilter::get_table()
+{
+    return _table;
+}
+unsigned long long int PreFilter::get_bytes()
+{
+    return (1ULL << _bits) / 8;
+}
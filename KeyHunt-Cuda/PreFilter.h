@@ -0,0 +1,56 @@
+#ifndef PREFILTER_H
+#define PREFILTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Key bytes read by the prefilter, past the 16 bytes of the Bloom probes
+#define PREFILTER_OFFSET 16
+
+#define PREFILTER_MIN_BITS 16
+#define PREFILTER_MAX_BITS 23   // 1 MB table, L2 resident on CPU and GPU
+
+// First level filter in front of the main filter: one bit per value of the
+// top bits of the 32 bits word at PREFILTER_OFFSET in the key. A cache hit
+// rejects most candidates before the DRAM access of the main filter. With a
+// single probe it is only worth it while the table is sparse, see useful().
+class PreFilter
+{
+public:
+    PreFilter(const uint8_t *data, uint64_t count, int len);
+    ~PreFilter();
+
+    inline int check(const void *key) const
+    {
+        uint32_t w;
+        memcpy(&w, (const uint8_t *)key + PREFILTER_OFFSET, 4);
+        w >>= _shift;
+        return (_table[w >> 3] >> (w & 7)) & 1;
+    }
+
+    // Offset of the byte holding the bit of a key, add() sets it
+    inline uint64_t byte_of(const void *key) const
+    {
+        uint32_t w;
+        memcpy(&w, (const uint8_t *)key + PREFILTER_OFFSET, 4);
+        return (w >> _shift) >> 3;
+    }
+    void add(const void *key);
+
+    // False when count targets would set more than half of the largest table
+    static bool useful(uint64_t count);
+    void print();
+
+    int get_shift();
+    const uint8_t *get_table();
+    unsigned long long int get_bytes();
+
+private:
+    int _bits;
+    int _shift;             // 32 - _bits
+    uint64_t _count;
+    uint64_t _set;          // bits set, the pass rate is _set / 2^_bits
+    uint8_t *_table;
+};
+
+#endif // PREFILTER_H
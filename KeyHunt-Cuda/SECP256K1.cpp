@@ -18,12 +18,22 @@
 #include "SECP256k1.h"
 #include "hash/sha256.h"
 #include "hash/ripemd160.h"
+#include "hash/cpuid.h"
 #include "Base58.h"
 #include "Bech32.h"
 #include <string.h>
 
 Secp256K1::Secp256K1()
 {
+    hasAVX2 = cpu_has_avx2();
+    hasAVX512 = cpu_has_avx512();
+    hasSHA = cpu_has_sha();
+
+    // SHA extensions are faster than the SIMD rounds when available
+    sha256x4_1B = hasSHA ? sha256shani_1B : sha256sse_1B;
+    sha256x4_2B = hasSHA ? sha256shani_2B : sha256sse_2B;
+    sha256x4_33 = hasSHA ? sha256shani_33 : sha256sse_33;
+    sha256x4_65 = hasSHA ? sha256shani_65 : sha256sse_65;
 }
 
 void Secp256K1::Init()
@@ -281,16 +291,16 @@ Int Secp256K1::DecodePrivateKey(char *key, bool *compressed)
 
 }
 
-#define KEYBUFFCOMP(buff,p) \
-(buff)[0] = ((p).x.bits[7] >> 8) | ((uint32_t)(0x2 + (p).y.IsOdd()) << 24); \
-(buff)[1] = ((p).x.bits[6] >> 8) | ((p).x.bits[7] <<24); \
-(buff)[2] = ((p).x.bits[5] >> 8) | ((p).x.bits[6] <<24); \
-(buff)[3] = ((p).x.bits[4] >> 8) | ((p).x.bits[5] <<24); \
-(buff)[4] = ((p).x.bits[3] >> 8) | ((p).x.bits[4] <<24); \
-(buff)[5] = ((p).x.bits[2] >> 8) | ((p).x.bits[3] <<24); \
-(buff)[6] = ((p).x.bits[1] >> 8) | ((p).x.bits[2] <<24); \
-(buff)[7] = ((p).x.bits[0] >> 8) | ((p).x.bits[1] <<24); \
-(buff)[8] = 0x00800000 | ((p).x.bits[0] <<24); \
+#define KEYBUFFCOMPX(buff,px,podd) \
+(buff)[0] = ((px).bits[7] >> 8) | ((uint32_t)(0x2 + (podd)) << 24); \
+(buff)[1] = ((px).bits[6] >> 8) | ((px).bits[7] <<24); \
+(buff)[2] = ((px).bits[5] >> 8) | ((px).bits[6] <<24); \
+(buff)[3] = ((px).bits[4] >> 8) | ((px).bits[5] <<24); \
+(buff)[4] = ((px).bits[3] >> 8) | ((px).bits[4] <<24); \
+(buff)[5] = ((px).bits[2] >> 8) | ((px).bits[3] <<24); \
+(buff)[6] = ((px).bits[1] >> 8) | ((px).bits[2] <<24); \
+(buff)[7] = ((px).bits[0] >> 8) | ((px).bits[1] <<24); \
+(buff)[8] = 0x00800000 | ((px).bits[0] <<24); \
 (buff)[9] = 0; \
 (buff)[10] = 0; \
 (buff)[11] = 0; \
@@ -299,24 +309,24 @@ Int Secp256K1::DecodePrivateKey(char *key, bool *compressed)
 (buff)[14] = 0; \
 (buff)[15] = 0x108;
 
-#define KEYBUFFUNCOMP(buff,p) \
-(buff)[0] = ((p).x.bits[7] >> 8) | 0x04000000; \
-(buff)[1] = ((p).x.bits[6] >> 8) | ((p).x.bits[7] <<24); \
-(buff)[2] = ((p).x.bits[5] >> 8) | ((p).x.bits[6] <<24); \
-(buff)[3] = ((p).x.bits[4] >> 8) | ((p).x.bits[5] <<24); \
-(buff)[4] = ((p).x.bits[3] >> 8) | ((p).x.bits[4] <<24); \
-(buff)[5] = ((p).x.bits[2] >> 8) | ((p).x.bits[3] <<24); \
-(buff)[6] = ((p).x.bits[1] >> 8) | ((p).x.bits[2] <<24); \
-(buff)[7] = ((p).x.bits[0] >> 8) | ((p).x.bits[1] <<24); \
-(buff)[8] = ((p).y.bits[7] >> 8) | ((p).x.bits[0] <<24); \
-(buff)[9] = ((p).y.bits[6] >> 8) | ((p).y.bits[7] <<24); \
-(buff)[10] = ((p).y.bits[5] >> 8) | ((p).y.bits[6] <<24); \
-(buff)[11] = ((p).y.bits[4] >> 8) | ((p).y.bits[5] <<24); \
-(buff)[12] = ((p).y.bits[3] >> 8) | ((p).y.bits[4] <<24); \
-(buff)[13] = ((p).y.bits[2] >> 8) | ((p).y.bits[3] <<24); \
-(buff)[14] = ((p).y.bits[1] >> 8) | ((p).y.bits[2] <<24); \
-(buff)[15] = ((p).y.bits[0] >> 8) | ((p).y.bits[1] <<24); \
-(buff)[16] = 0x00800000 | ((p).y.bits[0] <<24); \
+#define KEYBUFFUNCOMPXY(buff,px,py) \
+(buff)[0] = ((px).bits[7] >> 8) | 0x04000000; \
+(buff)[1] = ((px).bits[6] >> 8) | ((px).bits[7] <<24); \
+(buff)[2] = ((px).bits[5] >> 8) | ((px).bits[6] <<24); \
+(buff)[3] = ((px).bits[4] >> 8) | ((px).bits[5] <<24); \
+(buff)[4] = ((px).bits[3] >> 8) | ((px).bits[4] <<24); \
+(buff)[5] = ((px).bits[2] >> 8) | ((px).bits[3] <<24); \
+(buff)[6] = ((px).bits[1] >> 8) | ((px).bits[2] <<24); \
+(buff)[7] = ((px).bits[0] >> 8) | ((px).bits[1] <<24); \
+(buff)[8] = ((py).bits[7] >> 8) | ((px).bits[0] <<24); \
+(buff)[9] = ((py).bits[6] >> 8) | ((py).bits[7] <<24); \
+(buff)[10] = ((py).bits[5] >> 8) | ((py).bits[6] <<24); \
+(buff)[11] = ((py).bits[4] >> 8) | ((py).bits[5] <<24); \
+(buff)[12] = ((py).bits[3] >> 8) | ((py).bits[4] <<24); \
+(buff)[13] = ((py).bits[2] >> 8) | ((py).bits[3] <<24); \
+(buff)[14] = ((py).bits[1] >> 8) | ((py).bits[2] <<24); \
+(buff)[15] = ((py).bits[0] >> 8) | ((py).bits[1] <<24); \
+(buff)[16] = 0x00800000 | ((py).bits[0] <<24); \
 (buff)[17] = 0; \
 (buff)[18] = 0; \
 (buff)[19] = 0; \
@@ -333,6 +343,9 @@ Int Secp256K1::DecodePrivateKey(char *key, bool *compressed)
 (buff)[30] = 0; \
 (buff)[31] = 0x208;
 
+#define KEYBUFFCOMP(buff,p) KEYBUFFCOMPX(buff, (p).x, (p).y.IsOdd())
+#define KEYBUFFUNCOMP(buff,p) KEYBUFFUNCOMPXY(buff, (p).x, (p).y)
+
 #define KEYBUFFSCRIPT(buff,h) \
 (buff)[0] = 0x00140000 | (uint32_t)h[0] << 8 | (uint32_t)h[1]; \
 (buff)[1] = (uint32_t)h[2] << 24 | (uint32_t)h[3] << 16 | (uint32_t)h[4] << 8 | (uint32_t)h[5];\
@@ -385,7 +398,7 @@ void Secp256K1::GetHash160(int type, bool compressed,
             KEYBUFFUNCOMP(b2, k2);
             KEYBUFFUNCOMP(b3, k3);
 
-            sha256sse_2B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
+            sha256x4_65(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
             ripemd160sse_32(sh0, sh1, sh2, sh3, h0, h1, h2, h3);
 
         } else {
@@ -400,7 +413,7 @@ void Secp256K1::GetHash160(int type, bool compressed,
             KEYBUFFCOMP(b2, k2);
             KEYBUFFCOMP(b3, k3);
 
-            sha256sse_1B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
+            sha256x4_33(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
             ripemd160sse_32(sh0, sh1, sh2, sh3, h0, h1, h2, h3);
 
         }
@@ -428,7 +441,7 @@ void Secp256K1::GetHash160(int type, bool compressed,
         KEYBUFFSCRIPT(b2, kh2);
         KEYBUFFSCRIPT(b3, kh3);
 
-        sha256sse_1B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
+        sha256x4_1B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
         ripemd160sse_32(sh0, sh1, sh2, sh3, h0, h1, h2, h3);
 
     }
@@ -438,6 +451,172 @@ void Secp256K1::GetHash160(int type, bool compressed,
 
 }
 
+// Hash160 of w padded messages (w = 4, 8 or 16), hashes are written contiguously in h.
+// len is the message length, 33 and 65 byte keys use the kernels with constant folded
+// padding, other lengths (P2SH script) must fit in a single block.
+// The widest kernels available on the host are used, 16 must only be used with AVX-512.
+void Secp256K1::Hash160Blocks(int len, int w, uint32_t **b, uint8_t *h)
+{
+
+#ifdef WIN64
+    __declspec(align(16)) unsigned char sh[16][64];
+#else
+    unsigned char sh[16][64] __attribute__((aligned(16)));
+#endif
+
+    if (w == 16) {
+        // Fused SHA256 + RIPEMD160
+        switch (len) {
+        case 33:
+            hash160avx512_33(b, h);
+            break;
+        case 65:
+            hash160avx512_65(b, h);
+            break;
+        default:
+            hash160avx512(b, 1, h);
+            break;
+        }
+        return;
+    }
+
+    if (w == 8 && hasAVX2) {
+
+        if (hasSHA) {
+            switch (len) {
+            case 33:
+                sha256shani_33(b[0], b[1], b[2], b[3], sh[0], sh[1], sh[2], sh[3]);
+                sha256shani_33(b[4], b[5], b[6], b[7], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            case 65:
+                sha256shani_65(b[0], b[1], b[2], b[3], sh[0], sh[1], sh[2], sh[3]);
+                sha256shani_65(b[4], b[5], b[6], b[7], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            default:
+                sha256shani_1B(b[0], b[1], b[2], b[3], sh[0], sh[1], sh[2], sh[3]);
+                sha256shani_1B(b[4], b[5], b[6], b[7], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            }
+        } else {
+            switch (len) {
+            case 33:
+                sha256avx2_33(b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
+                              sh[0], sh[1], sh[2], sh[3], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            case 65:
+                sha256avx2_65(b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
+                              sh[0], sh[1], sh[2], sh[3], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            default:
+                sha256avx2_1B(b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7],
+                              sh[0], sh[1], sh[2], sh[3], sh[4], sh[5], sh[6], sh[7]);
+                break;
+            }
+        }
+
+        ripemd160avx2_32(sh[0], sh[1], sh[2], sh[3], sh[4], sh[5], sh[6], sh[7],
+                         h, h + 20, h + 40, h + 60, h + 80, h + 100, h + 120, h + 140);
+        return;
+
+    }
+
+    for (int i = 0; i < w; i += 4) {
+        switch (len) {
+        case 33:
+            sha256x4_33(b[i], b[i + 1], b[i + 2], b[i + 3], sh[i], sh[i + 1], sh[i + 2], sh[i + 3]);
+            break;
+        case 65:
+            sha256x4_65(b[i], b[i + 1], b[i + 2], b[i + 3], sh[i], sh[i + 1], sh[i + 2], sh[i + 3]);
+            break;
+        default:
+            sha256x4_1B(b[i], b[i + 1], b[i + 2], b[i + 3], sh[i], sh[i + 1], sh[i + 2], sh[i + 3]);
+            break;
+        }
+        ripemd160sse_32(sh[i], sh[i + 1], sh[i + 2], sh[i + 3],
+                        h + 20 * i, h + 20 * (i + 1), h + 20 * (i + 2), h + 20 * (i + 3));
+    }
+
+}
+
+// Hash160 of n public keys given by their affine coordinates, hashes are written
+// contiguously in h (n x 20 bytes). Compressed keys only use x and the parity of y
+// (odd), y can then be NULL. Uncompressed keys only use x and y, odd can be NULL.
+// Keys go through the widest kernel of the host (16, 8 or 4 way), the last lanes
+// of an incomplete chunk repeat the last key.
+void Secp256K1::GetHash160(int type, bool compressed, Int *x, Int *y, uint8_t *odd, int n, uint8_t *h)
+{
+
+    uint32_t b[16][32];
+    uint32_t *bs[16];
+    unsigned char tail[16 * 20];
+    int len = compressed ? 33 : 65;
+
+    for (int j = 0; j < 16; j++)
+        bs[j] = b[j];
+
+    for (int i = 0; i < n;) {
+
+        int w = (hasAVX512 && n - i >= 16) ? 16 : ((n - i >= 8) ? 8 : 4);
+        int m = (n - i < w) ? (n - i) : w;
+        uint8_t *d = (m == w) ? h + 20 * i : tail;
+
+        for (int j = 0; j < w; j++) {
+            int k = i + ((j < m) ? j : m - 1);
+            if (compressed) {
+                KEYBUFFCOMPX(b[j], x[k], odd[k]);
+            } else {
+                KEYBUFFUNCOMPXY(b[j], x[k], y[k]);
+            }
+        }
+
+        Hash160Blocks(len, w, bs, d);
+
+        if (d == tail)
+            memcpy(h + 20 * i, tail, 20 * m);
+
+        i += m;
+
+    }
+
+    if (type == P2SH)
+        GetHash160Script(h, n, h);
+
+}
+
+// Hash160 of the 1 to 1 redeem script (0x0014 followed by the key hash, P2SH-P2WPKH)
+// of n key hashes, kh and h may be the same buffer.
+void Secp256K1::GetHash160Script(uint8_t *kh, int n, uint8_t *h)
+{
+
+    uint32_t b[16][32];
+    uint32_t *bs[16];
+    unsigned char tail[16 * 20];
+
+    for (int j = 0; j < 16; j++)
+        bs[j] = b[j];
+
+    for (int i = 0; i < n;) {
+
+        int w = (hasAVX512 && n - i >= 16) ? 16 : ((n - i >= 8) ? 8 : 4);
+        int m = (n - i < w) ? (n - i) : w;
+        uint8_t *d = (m == w) ? h + 20 * i : tail;
+
+        for (int j = 0; j < w; j++) {
+            uint8_t *k = kh + 20 * (i + ((j < m) ? j : m - 1));
+            KEYBUFFSCRIPT(b[j], k);
+        }
+
+        Hash160Blocks(22, w, bs, d);
+
+        if (d == tail)
+            memcpy(h + 20 * i, tail, 20 * m);
+
+        i += m;
+
+    }
+
+}
+
 uint8_t Secp256K1::GetByte(std::string &str, int idx)
 {
 
@@ -723,6 +902,18 @@ std::string Secp256K1::GetAddress(int type, bool compressed, unsigned char *hash
     unsigned char address[25];
     switch (type) {
 
+    case XPOINT: {
+        // hash160 holds the 32 bytes of x
+        char tmp[3];
+        std::string ret;
+        for (int i = 0; i < 32; i++) {
+            sprintf(tmp, "%02X", (int)hash160[i]);
+            ret.append(tmp);
+        }
+        return ret;
+    }
+    break;
+
     case P2PKH:
         address[0] = 0x00;
         break;
@@ -757,6 +948,12 @@ std::string Secp256K1::GetAddress(int type, bool compressed, Point &pubKey)
         address[0] = 0x00;
         break;
 
+    case XPOINT: {
+        unsigned char x[32];
+        pubKey.x.Get32Bytes(x);
+        return GetAddress(XPOINT, compressed, x);
+    }
+
     case BECH32: {
         if (!compressed) {
             return " BECH32: Only compressed key ";
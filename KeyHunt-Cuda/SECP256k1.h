@@ -26,6 +26,7 @@
 #define P2PKH  0
 #define P2SH   1
 #define BECH32 2
+#define XPOINT 3   // x coordinate of the public key, no hash
 
 class Secp256K1
 {
@@ -45,6 +46,8 @@ public:
                     uint8_t *h0, uint8_t *h1, uint8_t *h2, uint8_t *h3);
 
     void GetHash160(int type, bool compressed, Point &pubKey, unsigned char *hash);
+    void GetHash160(int type, bool compressed, Int *x, Int *y, uint8_t *odd, int n, uint8_t *h);
+    void GetHash160Script(uint8_t *kh, int n, uint8_t *h);
 
     std::string GetAddress(int type, bool compressed, Point &pubKey);
     std::string GetAddress(int type, bool compressed, unsigned char *hash160);
@@ -69,9 +72,23 @@ public:
 private:
 
     uint8_t GetByte(std::string &str, int idx);
+    void Hash160Blocks(int len, int w, uint32_t **b, uint8_t *h);
 
     Int GetY(Int x, bool isEven);
     Point GTable[256 * 32];     // Generator table
+    bool  hasAVX2;              // AVX2 hash kernels available
+    bool  hasAVX512;            // AVX-512 hash kernel available
+    bool  hasSHA;               // SHA extensions available
+
+    // 4 way SHA256 kernels selected at runtime (SSE or SHA extensions)
+    void (*sha256x4_1B)(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                        uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+    void (*sha256x4_2B)(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                        uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+    void (*sha256x4_33)(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                        uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+    void (*sha256x4_65)(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                        uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
 
 };
 
@@ -0,0 +1,155 @@
+#include "TargetDelta.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+TargetDelta::TargetDelta(int len)
+{
+    _len = len;
+}
+
+TargetDelta::~TargetDelta()
+{
+}
+
+static int hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+TargetDelta *TargetDelta::load(const std::string &fileName, int len)
+{
+    FILE *f = fopen(fileName.c_str(), "r");
+    if (f == NULL) {
+        printf("Delta        : %s can not open\n", fileName.c_str());
+        return NULL;
+    }
+
+    // Records in file order, with their sign
+    std::vector<uint8_t> records;
+    std::vector<uint8_t> remove;
+    char line[256];
+    int lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineNo++;
+        char *p = line;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (*p == '#' || *p == '\r' || *p == '\n' || *p == 0)
+            continue;
+        bool minus = (*p == '-');
+        if (*p == '+' || *p == '-')
+            p++;
+        size_t start = records.size();
+        records.resize(start + len);
+        int i = 0;
+        for (; i < len; i++) {
+            int hi = hex_value(p[2 * i]);
+            int lo = (hi < 0) ? -1 : hex_value(p[2 * i + 1]);
+            if (lo < 0)
+                break;
+            records[start + i] = (uint8_t)((hi << 4) | lo);
+        }
+        char end = p[2 * len];
+        if (i < len || !(end == 0 || end == '\r' || end == '\n' || end == ' ' || end == '\t')) {
+            printf("Delta        : %s line %d, %d bytes hex record expected\n", fileName.c_str(), lineNo, len);
+            fclose(f);
+            return NULL;
+        }
+        remove.push_back(minus ? 1 : 0);
+    }
+    fclose(f);
+
+    // Sort by record then line, the last line of each record wins
+    uint64_t n = remove.size();
+    std::vector<uint64_t> order(n);
+    for (uint64_t i = 0; i < n; i++)
+        order[i] = i;
+    const uint8_t *r = records.data();
+    std::stable_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+        return memcmp(r + a * len, r + b * len, len) < 0;
+    });
+
+    TargetDelta *d = new TargetDelta(len);
+    for (uint64_t i = 0; i < n; i++) {
+        if (i + 1 < n && memcmp(r + order[i] * len, r + order[i + 1] * len, len) == 0)
+            continue;
+        std::vector<uint8_t> &dst = remove[order[i]] ? d->_removed : d->_added;
+        dst.insert(dst.end(), r + order[i] * len, r + order[i] * len + len);
+    }
+    return d;
+}
+
+bool TargetDelta::contains(const std::vector<uint8_t> &records, const uint8_t *key) const
+{
+    uint64_t min = 0;
+    uint64_t max = records.size() / _len;
+    while (min < max) {
+        uint64_t mid = min + (max - min) / 2;
+        int c = memcmp(records.data() + mid * _len, key, _len);
+        if (c == 0)
+            return true;
+        if (c < 0)
+            min = mid + 1;
+        else
+            max = mid;
+    }
+    return false;
+}
+
+bool TargetDelta::added(const uint8_t *key) const
+{
+    return contains(_added, key);
+}
+
+bool TargetDelta::removed(const uint8_t *key) const
+{
+    return contains(_removed, key);
+}
+
+void TargetDelta::print()
+{
+    printf("Delta        : %llu added, %llu removed\n",
+        (unsigned long long)get_added_count(), (unsigned long long)get_removed_count());
+}
+
+uint64_t TargetDelta::get_added_count() const
+{
+    return _added.size() / _len;
+}
+uint64_t TargetDelta::get_removed_count() const
+{
+    return _removed.size() / _len;
+}
+const uint8_t *TargetDelta::get_added() const
+{
+    return _added.data();
+}
+const uint8_t *TargetDelta::get_removed() const
+{
+    return _removed.data();
+}
+
+uint64_t TargetDelta::file_time(const std::string &fileName)
+{
+#ifdef WIN64
+    struct __stat64 st;
+    if (_stat64(fileName.c_str(), &st) != 0)
+        return 0;
+    return (uint64_t)st.st_mtime * 1000000000ULL;
+#else
+    struct stat st;
+    if (stat(fileName.c_str(), &st) != 0)
+        return 0;
+    return (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+#endif
+}
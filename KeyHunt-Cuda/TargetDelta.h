@@ -0,0 +1,41 @@
+#ifndef TARGETDELTA_H
+#define TARGETDELTA_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Targets added to or removed from the target file while the search runs.
+// The delta file is a text file of hex records (hash160 or x point), one per
+// line, "+" or no sign to add, "-" to remove; the last line of a record wins.
+// A loaded delta is immutable, a new one replaces it when the file changes.
+class TargetDelta
+{
+public:
+    // NULL with a message when a line is invalid
+    static TargetDelta *load(const std::string &fileName, int len);
+    ~TargetDelta();
+
+    bool added(const uint8_t *key) const;
+    bool removed(const uint8_t *key) const;
+    void print();
+
+    uint64_t get_added_count() const;
+    uint64_t get_removed_count() const;
+    const uint8_t *get_added() const;   // sorted records
+    const uint8_t *get_removed() const; // sorted records
+
+    // Modification time in ns, 0 when the file is missing
+    static uint64_t file_time(const std::string &fileName);
+
+private:
+    TargetDelta(int len);
+    bool contains(const std::vector<uint8_t> &records, const uint8_t *key) const;
+
+private:
+    int _len;
+    std::vector<uint8_t> _added;
+    std::vector<uint8_t> _removed;
+};
+
+#endif // TARGETDELTA_H
@@ -0,0 +1,247 @@
+#include "TargetIndex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xmmintrin.h>
+#ifndef WIN64
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Buckets larger than this are searched by bisection (skewed target files)
+#define INDEX_LINEAR_MAX 16
+
+// Parameters of a saved index, after the magic and the header size
+typedef struct {
+    uint64_t count;
+    int len;
+    int bits;
+} INDEX_HEADER;
+
+TargetIndex::TargetIndex(const uint8_t *data, uint64_t count, int len, bool build)
+{
+    _data = data;
+    _count = count;
+    _len = len;
+    _bits = 0;
+    _offsets = NULL;
+    _mapped = false;
+    _fullLen = 0;
+#ifdef WIN64
+    _file = INVALID_HANDLE_VALUE;
+#else
+    _fd = -1;
+#endif
+    if (!build)
+        return;
+
+    // About 4 to 8 records per bucket
+    _bits = INDEX_MIN_BITS;
+    while (_bits < INDEX_MAX_BITS && (count >> (_bits + 3)) > 0)
+        _bits++;
+
+    uint64_t nbBucket = 1ULL << _bits;
+    _offsets = (uint64_t *)malloc((size_t)(nbBucket + 1) * sizeof(uint64_t));
+    if (_offsets == NULL) {
+        printf("Target index init error\n");
+        exit(1);
+    }
+
+    // The array is sorted, bucket b starts at the first record whose prefix is >= b
+    uint64_t i = 0;
+    for (uint64_t b = 0; b < nbBucket; b++) {
+        while (i < count && prefix(data + i * len) < b)
+            i++;
+        _offsets[b] = i;
+    }
+    _offsets[nbBucket] = count;
+}
+
+TargetIndex::~TargetIndex()
+{
+    if (!_mapped)
+        free(_offsets);
+#ifdef WIN64
+    if (_file != INVALID_HANDLE_VALUE)
+        CloseHandle(_file);
+#else
+    if (_fd >= 0)
+        close(_fd);
+#endif
+}
+
+bool TargetIndex::open_records(const std::string &fileName, int fullLen)
+{
+#ifdef WIN64
+    _file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+        FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+        return false;
+#else
+    _fd = open(fileName.c_str(), O_RDONLY);
+    if (_fd < 0)
+        return false;
+    posix_fadvise(_fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+    _fullLen = fullLen;
+    return true;
+}
+
+// Full record i read from the target file (thread safe, no shared file offset)
+bool TargetIndex::confirm(const uint8_t *key, uint64_t i) const
+{
+    uint8_t rec[64];
+    uint64_t offset = i * _fullLen;
+#ifdef WIN64
+    OVERLAPPED ov;
+    memset(&ov, 0, sizeof(ov));
+    ov.Offset = (DWORD)offset;
+    ov.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD n = 0;
+    bool ok = ReadFile(_file, rec, _fullLen, &n, &ov) && n == (DWORD)_fullLen;
+#else
+    bool ok = pread(_fd, rec, _fullLen, (off_t)offset) == _fullLen;
+#endif
+    if (!ok) {
+        printf("Target file read error at record %llu\n", (unsigned long long)i);
+        return false;
+    }
+    return memcmp(key, rec, _fullLen) == 0;
+}
+
+uint32_t TargetIndex::prefix(const uint8_t *key) const
+{
+    uint32_t p = ((uint32_t)key[0] << 16) | ((uint32_t)key[1] << 8) | (uint32_t)key[2];
+    return p >> (24 - _bits);
+}
+
+// The bucket start is read from the offsets, the records are uniformly
+// distributed so their line is guessed from the bucket number
+void TargetIndex::prefetch(const uint8_t *key) const
+{
+    uint32_t b = prefix(key);
+    _mm_prefetch((const char *)(_offsets + b), _MM_HINT_T0);
+    uint64_t guess = ((_count >> 8) * b) >> (_bits - 8);
+    _mm_prefetch((const char *)(_data + guess * _len), _MM_HINT_T0);
+}
+
+bool TargetIndex::find(const uint8_t *key) const
+{
+    uint32_t b = prefix(key);
+    uint64_t min = _offsets[b];
+    uint64_t end = _offsets[b + 1];
+    uint64_t max = end;
+
+    // Lower bound, prefixes of a compact store may repeat
+    while (max - min > INDEX_LINEAR_MAX) {
+        uint64_t mid = min + (max - min) / 2;
+        if (memcmp(_data + mid * _len, key, _len) < 0)
+            min = mid + 1;
+        else
+            max = mid + 1;
+    }
+
+    // Equal prefixes may go on past max
+    for (uint64_t i = min; i < end; i++) {
+        int c = memcmp(key, _data + i * _len, _len);
+        if (c == 0 && (_fullLen == 0 || confirm(key, i)))
+            return true;
+        if (c < 0)
+            break;
+    }
+
+    return false;
+}
+
+int TargetIndex::save(FILE *f)
+{
+    if (_offsets == NULL)
+        return 1;
+
+    INDEX_HEADER h;
+    memset(&h, 0, sizeof(h));
+    h.count = _count;
+    h.len = _len;
+    h.bits = _bits;
+
+    unsigned char head[INDEX_FILE_HEADER];
+    uint16_t size = sizeof(INDEX_HEADER);
+    memset(head, 0, sizeof(head));
+    memcpy(head, INDEX_MAGIC, strlen(INDEX_MAGIC));
+    memcpy(head + 16, &size, sizeof(uint16_t));
+    memcpy(head + 24, &h, sizeof(h));
+
+    size_t bytes = (size_t)((1ULL << _bits) + 1) * sizeof(uint64_t);
+    if (fwrite(head, 1, sizeof(head), f) != sizeof(head))
+        return 2;
+    if (fwrite(_offsets, 1, bytes, f) != bytes)
+        return 3;
+    return 0;
+}
+
+// The offsets are used in place, buf must stay valid (and 8 bytes aligned)
+// for the life of the index. It must have been saved for the same targets.
+int TargetIndex::load(const unsigned char *buf, unsigned long long size)
+{
+    if (_offsets != NULL)
+        return 1;
+    if (size < INDEX_FILE_HEADER || memcmp(buf, INDEX_MAGIC, strlen(INDEX_MAGIC)) != 0)
+        return 2;
+
+    uint16_t hsize;
+    memcpy(&hsize, buf + 16, sizeof(uint16_t));
+    if (hsize != sizeof(INDEX_HEADER))
+        return 3;
+
+    INDEX_HEADER h;
+    memcpy(&h, buf + 24, sizeof(h));
+    // The offsets only depend on the first 3 bytes of the targets, they are
+    // the same for the full records and for the prefixes of a compact store
+    if (h.count != _count || h.bits < INDEX_MIN_BITS || h.bits > INDEX_MAX_BITS)
+        return 4;
+    if (size < INDEX_FILE_HEADER + ((1ULL << h.bits) + 1) * sizeof(uint64_t))
+        return 5;
+
+    _bits = h.bits;
+    _offsets = (uint64_t *)(buf + INDEX_FILE_HEADER);
+    _mapped = true;
+    return 0;
+}
+
+// Shift the offsets of a loaded index by the records inserted in and dropped
+// from the target file (sorted, len bytes each), in the loaded buffer
+int TargetIndex::merge(const uint8_t *inserted, uint64_t nInserted, const uint8_t *dropped, uint64_t nDropped)
+{
+    if (!_mapped)
+        return 1;
+
+    // A bucket moves by the records inserted and dropped before it
+    uint64_t nbBucket = 1ULL << _bits;
+    uint64_t i = 0;
+    uint64_t d = 0;
+    for (uint64_t b = 0; b <= nbBucket; b++) {
+        while (i < nInserted && prefix(inserted + i * _len) < b)
+            i++;
+        while (d < nDropped && prefix(dropped + d * _len) < b)
+            d++;
+        _offsets[b] = _offsets[b] + i - d;
+    }
+    _count = _count + nInserted - nDropped;
+
+    INDEX_HEADER h;
+    unsigned char *head = (unsigned char *)_offsets - INDEX_FILE_HEADER;
+    memcpy(&h, head + 24, sizeof(h));
+    h.count = _count;
+    memcpy(head + 24, &h, sizeof(h));
+    return 0;
+}
+
+void TargetIndex::print()
+{
+    printf("Index at %p\n", (void *)this);
+    printf("  Prefix     : %d bits\n", _bits);
+    printf("  Bucket avg : %.2f\n", (double)_count / (double)(1ULL << _bits));
+    printf("  Bytes      : %llu\n", (unsigned long long)(((1ULL << _bits) + 1) * sizeof(uint64_t)));
+    if (_fullLen)
+        printf("  Records    : %d of %d bytes in memory, hits read from file\n", _len, _fullLen);
+}
@@ -0,0 +1,57 @@
+#ifndef TARGETINDEX_H
+#define TARGETINDEX_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#ifdef WIN64
+#include <Windows.h>
+#endif
+
+#define INDEX_MIN_BITS 16
+#define INDEX_MAX_BITS 24
+
+// Saved index: magic, header and parameters, then the offsets
+#define INDEX_MAGIC "index1"
+#define INDEX_FILE_HEADER 64
+
+// Exact membership test over the sorted target array (hash160 or x point).
+// Targets are uniformly distributed, a table of bucket offsets over their
+// first bits leaves a few records per bucket, scanned linearly: a lookup
+// costs one or two cache misses instead of log2(N) for a binary search.
+class TargetIndex
+{
+public:
+    TargetIndex(const uint8_t *data, uint64_t count, int len, bool build = true);
+    ~TargetIndex();
+    bool find(const uint8_t *key) const;
+    void prefetch(const uint8_t *key) const;
+    void print();
+    int save(FILE *f);
+    int load(const unsigned char *buf, unsigned long long int size);
+    int merge(const uint8_t *inserted, uint64_t nInserted, const uint8_t *dropped, uint64_t nDropped);
+
+    // Compact store: data holds the first len bytes of each target only, a
+    // prefix match is confirmed by reading the fullLen bytes record from the file
+    bool open_records(const std::string &fileName, int fullLen);
+
+private:
+    uint32_t prefix(const uint8_t *key) const;
+    bool confirm(const uint8_t *key, uint64_t i) const;
+
+private:
+    const uint8_t *_data;
+    uint64_t _count;
+    int _len;
+    int _bits;
+    uint64_t *_offsets;   // (1 << _bits) + 1 bucket starts
+    bool _mapped;         // _offsets points in a loaded buffer, not owned
+    int _fullLen;         // record length in the file, 0 when data holds full records
+#ifdef WIN64
+    HANDLE _file;
+#else
+    int _fd;
+#endif
+};
+
+#endif // TARGETINDEX_H
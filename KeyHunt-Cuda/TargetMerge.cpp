@@ -0,0 +1,112 @@
+#include "TargetMerge.h"
+#include "TargetDelta.h"
+#include "TargetSort.h"
+#include "TargetIndex.h"
+#include "FilterCache.h"
+#include "FuseFilter.h"
+#include "Bloom.h"
+#include <stdio.h>
+#include <vector>
+
+// Formats of the caches a search may have saved next to the target file
+static const int cacheFormats[] = {
+    BLOOM_CLASSIC | BLOOM_DIRECT, BLOOM_BLOCKED | BLOOM_DIRECT, FILTER_FUSE8, FILTER_FUSE16
+};
+#define NB_CACHE_FORMAT 4
+
+static void removeCache(FilterCache *cache, const char *reason)
+{
+    std::string name = cache->get_file_name();
+    delete cache;
+    remove(name.c_str());
+    printf("Cache        : %s removed (%s), rebuilt on the next start\n", name.c_str(), reason);
+}
+
+// Bloom filter and index of a cache loaded for update, NULL or why it can't be updated
+static const char *updateCache(FilterCache *cache, uint64_t oldCount, int len,
+                               const std::vector<uint8_t> &inserted, const std::vector<uint8_t> &dropped)
+{
+    unsigned long long filterSize = 0;
+    unsigned long long indexSize = 0;
+    const unsigned char *filterData = cache->get_section(CACHE_FILTER, &filterSize);
+    const unsigned char *indexData = cache->get_section(CACHE_INDEX, &indexSize);
+
+    Bloom bloom;
+    TargetIndex index(NULL, oldCount, len, false);
+    if (bloom.load(filterData, filterSize) != 0 || index.load(indexData, indexSize) != 0)
+        return "invalid";
+
+    uint64_t nInserted = inserted.size() / len;
+    uint64_t nDropped = dropped.size() / len;
+    if (oldCount + nInserted - nDropped > bloom.get_entries())
+        return "filter full";
+
+    for (uint64_t i = 0; i < nInserted; i++)
+        bloom.add(inserted.data() + i * len, len);
+    if (index.merge(inserted.data(), nInserted, dropped.data(), nDropped) != 0)
+        return "invalid";
+    return NULL;
+}
+
+bool MergeTargets(const std::string &targetFile, const std::string &deltaFile, int len, int nbThread)
+{
+    TargetDelta *delta = TargetDelta::load(deltaFile, len);
+    if (delta == NULL)
+        return false;
+    delta->print();
+
+    std::vector<uint8_t> inserted;
+    std::vector<uint8_t> dropped;
+    MERGE_INFO info;
+    bool merged = MergeTargetFile(targetFile, len, delta->get_added(), delta->get_added_count(),
+                                  delta->get_removed(), delta->get_removed_count(), inserted, dropped, &info);
+    if (!merged) {
+        printf("Sorting      : %s is not sorted, sorting and removing duplicates\n", targetFile.c_str());
+        SortTargetFile(targetFile, len, nbThread, SortMemoryLimit());
+        merged = MergeTargetFile(targetFile, len, delta->get_added(), delta->get_added_count(),
+                                 delta->get_removed(), delta->get_removed_count(), inserted, dropped, &info);
+    }
+    delete delta;
+    if (!merged) {
+        printf("Merge        : %s can not be sorted\n", targetFile.c_str());
+        return false;
+    }
+
+    // The caches are matched against the file before the merge, then
+    // updated once the merged file is in place
+    FilterCache *caches[NB_CACHE_FORMAT];
+    for (int i = 0; i < NB_CACHE_FORMAT; i++) {
+        caches[i] = new FilterCache(targetFile, cacheFormats[i], len, info.oldSize, info.oldHash);
+        if (!caches[i]->load(true)) {
+            delete caches[i];
+            caches[i] = NULL;
+        }
+    }
+
+    ReplaceTargetFile(targetFile);
+    printf("Merged       : %s, %llu targets (%llu inserted, %llu removed)\n", targetFile.c_str(),
+           (unsigned long long)(info.size / len), (unsigned long long)(inserted.size() / len),
+           (unsigned long long)(dropped.size() / len));
+
+    for (int i = 0; i < NB_CACHE_FORMAT; i++) {
+        FilterCache *cache = caches[i];
+        if (cache == NULL)
+            continue;
+        const char *error = NULL;
+        if (cacheFormats[i] == FILTER_FUSE8 || cacheFormats[i] == FILTER_FUSE16) {
+            removeCache(cache, "static filter");
+        }
+        else if ((error = updateCache(cache, info.oldSize / len, len, inserted, dropped)) != NULL) {
+            removeCache(cache, error);
+        }
+        else if (!cache->rekey(targetFile, info.size, info.hash)) {
+            removeCache(cache, "write error");
+        }
+        else {
+            printf("Cache        : %s updated\n", cache->get_file_name().c_str());
+            delete cache;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,17 @@
+#ifndef TARGETMERGE_H
+#define TARGETMERGE_H
+
+#include <string>
+
+// Incremental update of a sorted target file with a delta file (TargetDelta
+// format, "+" to add, "-" to remove). The file is merged in one streaming
+// pass and the saved filters and indexes are updated in place instead of
+// being rebuilt: the Bloom filters get the bits of the inserted targets (the
+// dropped ones keep theirs, a false positive at most) and the index offsets
+// are shifted. A Bloom filter holding more targets than it was sized for
+// (twice the targets it was built from) is removed, as are the fuse filters,
+// which can't take new keys; they are rebuilt on the next start.
+// Return false with a message on an invalid delta file.
+bool MergeTargets(const std::string &targetFile, const std::string &deltaFile, int len, int nbThread);
+
+#endif // TARGETMERGE_H
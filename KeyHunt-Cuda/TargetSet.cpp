@@ -0,0 +1,110 @@
+#include "TargetSet.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+static uint32_t prefix_of(const uint8_t *rec)
+{
+    uint32_t p;
+    memcpy(&p, rec, 4);
+    return p;
+}
+
+TargetSet::TargetSet(const uint8_t *data, int count, int len)
+{
+    _len = len;
+
+    // Prefix order, duplicates removed
+    std::vector<int> order(count);
+    for (int i = 0; i < count; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        uint32_t pa = prefix_of(data + a * len);
+        uint32_t pb = prefix_of(data + b * len);
+        return (pa != pb) ? (pa < pb) : (memcmp(data + a * len, data + b * len, len) < 0);
+    });
+    order.erase(std::unique(order.begin(), order.end(), [&](int a, int b) {
+        return memcmp(data + a * len, data + b * len, len) == 0;
+    }), order.end());
+
+    // An empty set keeps one block of padding, find() needs one
+    _count = (int)order.size();
+    _blocks = (_count > 0) ? (_count + SET_BLOCK - 1) / SET_BLOCK : 1;
+    _groups = (_blocks + SET_BLOCK - 1) / SET_BLOCK;
+    _prefixes = (uint32_t *)_mm_malloc(_blocks * SET_BLOCK * sizeof(uint32_t), 64);
+    _fences = (uint32_t *)malloc(_blocks * sizeof(uint32_t));
+    _mid = (uint32_t *)_mm_malloc(_groups * SET_BLOCK * sizeof(uint32_t), 64);
+    _top = (uint32_t *)_mm_malloc(SET_BLOCK * sizeof(uint32_t), 64);
+    _records = (uint8_t *)malloc(_count * len + 1);
+    if (_prefixes == NULL || _fences == NULL || _mid == NULL || _top == NULL || _records == NULL) {
+        printf("Target set init error\n");
+        exit(1);
+    }
+
+    for (int i = 0; i < _blocks * SET_BLOCK; i++)
+        _prefixes[i] = 0xFFFFFFFF;
+    for (int i = 0; i < _count; i++) {
+        memcpy(_records + i * len, data + order[i] * len, len);
+        _prefixes[i] = prefix_of(_records + i * len);
+    }
+    for (int b = 0; b < _blocks; b++)
+        _fences[b] = _prefixes[b * SET_BLOCK + SET_BLOCK - 1];
+
+    // Padding sorts after any key, biased 0xFFFFFFFF
+    for (int i = 0; i < _groups * SET_BLOCK; i++)
+        _mid[i] = ((i < _blocks) ? _fences[i] : 0xFFFFFFFF) ^ 0x80000000;
+    for (int g = 0; g < SET_BLOCK; g++)
+        _top[g] = (g < _groups) ? _mid[g * SET_BLOCK + SET_BLOCK - 1] : 0x7FFFFFFF;
+}
+
+TargetSet::~TargetSet()
+{
+    _mm_free(_prefixes);
+    free(_fences);
+    _mm_free(_mid);
+    _mm_free(_top);
+    free(_records);
+}
+
+// i is the first prefix equal to k, targets sharing it follow
+bool TargetSet::confirm(const uint8_t *key, uint32_t k, int i) const
+{
+    for (; i < _count && _prefixes[i] == k; i++)
+        if (memcmp(_records + i * _len, key, _len) == 0)
+            return true;
+    return false;
+}
+
+void TargetSet::print()
+{
+    printf("Target set at %p\n", (void *)this);
+    printf("  Targets    : %d\n", _count);
+    printf("  Blocks     : %d x %d prefixes\n", _blocks, SET_BLOCK);
+    printf("  Bytes      : %d\n", (_blocks + _groups + 1) * SET_BLOCK * 4 + _blocks * 4 + _count * _len);
+}
+
+int TargetSet::get_count()
+{
+    return _count;
+}
+int TargetSet::get_len()
+{
+    return _len;
+}
+int TargetSet::get_blocks()
+{
+    return _blocks;
+}
+const uint32_t *TargetSet::get_prefixes()
+{
+    return _prefixes;
+}
+const uint32_t *TargetSet::get_fences()
+{
+    return _fences;
+}
+const uint8_t *TargetSet::get_records()
+{
+    return _records;
+}
@@ -0,0 +1,98 @@
+#ifndef TARGETSET_H
+#define TARGETSET_H
+
+#include <stdint.h>
+#include <string.h>
+#include <emmintrin.h>
+#ifdef WIN64
+#include <intrin.h>
+#endif
+
+#define SET_BLOCK 16            // prefixes compared at once, 4 SSE2 words
+#define SET_MAX_TARGETS 4096    // 16 KB of prefixes, L1 resident
+#define SET_MAX_BLOCKS (SET_MAX_TARGETS / SET_BLOCK)
+
+// Exact membership test over a few targets given on the command line
+// (hash160 or x point). The 32 bits prefixes are sorted and split in blocks
+// of SET_BLOCK, the last prefix of each block is kept as a fence and the
+// last fence of each SET_BLOCK fences as a top fence. A lookup is three
+// SIMD compares of 16 values, top fences, fences then prefixes, without
+// branches to mispredict, and the full record is only read on a prefix match.
+class TargetSet
+{
+public:
+    TargetSet(const uint8_t *data, int count, int len);
+    ~TargetSet();
+
+    inline bool find(const void *key) const
+    {
+        uint32_t k;
+        memcpy(&k, key, 4);
+
+        // Fences are biased for the signed compare of SSE2. A key above all
+        // the fences is clamped to the last block, where no prefix matches:
+        // branching out would be mispredicted for small sets.
+        int b = 0;
+        if (_blocks > 1) {
+            const __m128i kb = _mm_set1_epi32((int)(k ^ 0x80000000));
+            int g = first_bit(~mask16(_top, kb, true));
+            g = (g < _groups) ? g : _groups - 1;
+            b = g * SET_BLOCK + first_bit(~mask16(_mid + g * SET_BLOCK, kb, true));
+            b = (b < _blocks) ? b : _blocks - 1;
+        }
+
+        int m = mask16(_prefixes + b * SET_BLOCK, _mm_set1_epi32((int)k), false);
+        if (m == 0)
+            return false;
+
+        return confirm((const uint8_t *)key, k, b * SET_BLOCK + first_bit(m));
+    }
+
+    void print();
+
+    int get_count();
+    int get_len();
+    int get_blocks();
+    const uint32_t *get_prefixes();     // get_blocks() * SET_BLOCK, padded with 0xFFFFFFFF
+    const uint32_t *get_fences();       // get_blocks()
+    const uint8_t *get_records();       // get_count() * get_len(), in prefix order
+
+private:
+    bool confirm(const uint8_t *key, uint32_t k, int i) const;
+
+    // Bit i set when v[i] < k (less) or v[i] == k, for 16 values
+    static inline int mask16(const uint32_t *v, __m128i k, bool less)
+    {
+        const __m128i *p = (const __m128i *)v;
+        int m = 0;
+        for (int i = 0; i < 4; i++) {
+            __m128i c = less ? _mm_cmpgt_epi32(k, p[i]) : _mm_cmpeq_epi32(p[i], k);
+            m |= _mm_movemask_ps(_mm_castsi128_ps(c)) << (4 * i);
+        }
+        return m;
+    }
+
+    static inline int first_bit(int m)
+    {
+#ifdef WIN64
+        unsigned long i;
+        _BitScanForward(&i, (unsigned long)m);
+        return (int)i;
+#else
+        return __builtin_ctz((unsigned int)m);
+#endif
+    }
+
+private:
+    int _count;
+    int _len;
+    int _blocks;
+    int _groups;            // blocks / SET_BLOCK, rounded up
+    uint32_t *_prefixes;
+    uint32_t *_fences;
+    uint32_t *_mid;         // biased fences, _groups * SET_BLOCK
+    uint32_t *_top;         // biased top fences, SET_BLOCK
+    uint8_t *_records;
+};
+
+#endif // TARGETSET_H
@@ -0,0 +1,615 @@
+#include "TargetSort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <queue>
+#include <vector>
+#ifdef WIN64
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Radix buckets, first 16 bits of the records
+#define SORT_BUCKETS 65536
+
+// Read buffer of each run during the merge
+#define MERGE_BUFFER (4 * 1024 * 1024)
+
+// Chunk of the content hash, the chunk hashes are summed in any order
+#define HASH_CHUNK (1024 * 1024)
+
+typedef struct {
+
+    int threadId;
+    int nbThread;
+    const uint8_t *src;
+    uint8_t *dst;
+    uint64_t count;
+    int len;
+    uint64_t *hist;                 // nbThread x SORT_BUCKETS counts, then scatter offsets
+    uint64_t *bucketStart;          // SORT_BUCKETS + 1
+    std::atomic<uint32_t> *next;    // next bucket to sort
+    bool sorted;
+    uint64_t hash;
+
+} SORT_PARAM;
+
+template <int LEN> struct Record {
+    uint8_t b[LEN];
+    bool operator<(const Record &r) const { return memcmp(b, r.b, LEN) < 0; }
+};
+
+static void sortBucket(uint8_t *p, uint64_t n, int len)
+{
+    if (len == 20)
+        std::sort((Record<20> *)p, (Record<20> *)p + n);
+    else
+        std::sort((Record<32> *)p, (Record<32> *)p + n);
+}
+
+static inline uint32_t bucketOf(const uint8_t *r)
+{
+    return ((uint32_t)r[0] << 8) | r[1];
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef WIN64
+static DWORD WINAPI runThread(LPVOID lpParam);
+#else
+static void *runThread(void *lpParam);
+#endif
+
+static void (*threadFunc)(SORT_PARAM *p);
+
+static void runThreads(void (*f)(SORT_PARAM *), SORT_PARAM *params, int nbThread)
+{
+    threadFunc = f;
+#ifdef WIN64
+    HANDLE *th = (HANDLE *)malloc(nbThread * sizeof(HANDLE));
+    for (int t = 0; t < nbThread; t++) {
+        DWORD thread_id;
+        th[t] = CreateThread(NULL, 0, runThread, (void *)(params + t), 0, &thread_id);
+    }
+    for (int t = 0; t < nbThread; t++) {
+        WaitForSingleObject(th[t], INFINITE);
+        CloseHandle(th[t]);
+    }
+#else
+    pthread_t *th = (pthread_t *)malloc(nbThread * sizeof(pthread_t));
+    for (int t = 0; t < nbThread; t++)
+        pthread_create(&th[t], NULL, &runThread, (void *)(params + t));
+    for (int t = 0; t < nbThread; t++)
+        pthread_join(th[t], NULL);
+#endif
+    free(th);
+}
+
+#ifdef WIN64
+static DWORD WINAPI runThread(LPVOID lpParam)
+#else
+static void *runThread(void *lpParam)
+#endif
+{
+    threadFunc((SORT_PARAM *)lpParam);
+    return 0;
+}
+
+// Slice [start, end) of the records handled by a thread
+static void slice(SORT_PARAM *p, uint64_t &start, uint64_t &end)
+{
+    start = p->count * p->threadId / p->nbThread;
+    end = p->count * (p->threadId + 1) / p->nbThread;
+}
+
+static void checkSlice(SORT_PARAM *p)
+{
+    uint64_t start, end;
+    slice(p, start, end);
+    p->sorted = true;
+    for (uint64_t i = start; i < end && i + 1 < p->count; i++) {
+        if (memcmp(p->src + i * p->len, p->src + (i + 1) * p->len, p->len) >= 0) {
+            p->sorted = false;
+            return;
+        }
+    }
+}
+
+static inline uint64_t mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// Hash of chunk c (n bytes at b) of a content
+static uint64_t hashChunk(const uint8_t *b, uint64_t n, uint64_t c)
+{
+    uint64_t h = mix64(c + 1);
+    uint64_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, b + i, 8);
+        h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+    }
+    for (; i < n; i++)
+        h = (h ^ b[i]) * 0x100000001b3ULL;
+    return mix64(h);
+}
+
+// Chunks t, t + nbThread, ... of the count bytes at src
+static void hashChunks(SORT_PARAM *p)
+{
+    uint64_t nbChunk = (p->count + HASH_CHUNK - 1) / HASH_CHUNK;
+    p->hash = 0;
+    for (uint64_t c = p->threadId; c < nbChunk; c += p->nbThread) {
+        uint64_t n = std::min((uint64_t)HASH_CHUNK, p->count - c * HASH_CHUNK);
+        p->hash += hashChunk(p->src + c * HASH_CHUNK, n, c);
+    }
+}
+
+static void histSlice(SORT_PARAM *p)
+{
+    uint64_t start, end;
+    slice(p, start, end);
+    uint64_t *h = p->hist + (uint64_t)p->threadId * SORT_BUCKETS;
+    for (uint64_t i = start; i < end; i++)
+        h[bucketOf(p->src + i * p->len)]++;
+}
+
+static void scatterSlice(SORT_PARAM *p)
+{
+    uint64_t start, end;
+    slice(p, start, end);
+    uint64_t *off = p->hist + (uint64_t)p->threadId * SORT_BUCKETS;
+    for (uint64_t i = start; i < end; i++) {
+        const uint8_t *r = p->src + i * p->len;
+        memcpy(p->dst + (off[bucketOf(r)]++) * p->len, r, p->len);
+    }
+}
+
+static void sortBuckets(SORT_PARAM *p)
+{
+    uint32_t b;
+    while ((b = p->next->fetch_add(1)) < SORT_BUCKETS) {
+        uint64_t n = p->bucketStart[b + 1] - p->bucketStart[b];
+        if (n > 1)
+            sortBucket(p->dst + p->bucketStart[b] * p->len, n, p->len);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+bool TargetsSorted(const uint8_t *data, uint64_t count, int len, int nbThread)
+{
+    if (nbThread < 1)
+        nbThread = 1;
+    SORT_PARAM *params = new SORT_PARAM[nbThread];
+    for (int t = 0; t < nbThread; t++) {
+        params[t].threadId = t;
+        params[t].nbThread = nbThread;
+        params[t].src = data;
+        params[t].count = count;
+        params[t].len = len;
+    }
+    runThreads(checkSlice, params, nbThread);
+    bool sorted = true;
+    for (int t = 0; t < nbThread; t++)
+        sorted &= params[t].sorted;
+    delete[] params;
+    return sorted;
+}
+
+uint64_t TargetsHash(const uint8_t *data, uint64_t size, int nbThread)
+{
+    if (nbThread < 1)
+        nbThread = 1;
+    SORT_PARAM *params = new SORT_PARAM[nbThread];
+    for (int t = 0; t < nbThread; t++) {
+        params[t].threadId = t;
+        params[t].nbThread = nbThread;
+        params[t].src = data;
+        params[t].count = size;
+    }
+    runThreads(hashChunks, params, nbThread);
+    uint64_t hash = mix64(size);
+    for (int t = 0; t < nbThread; t++)
+        hash += params[t].hash;
+    delete[] params;
+    return hash;
+}
+
+// Parallel MSD radix pass on the first 16 bits (src to dst), then the buckets
+// are sorted independently and the duplicates removed. Return the number of
+// distinct records left at the start of dst.
+static uint64_t sortRecords(const uint8_t *src, uint8_t *dst, uint64_t count, int len, int nbThread)
+{
+    if (nbThread < 1 || count < 65536)
+        nbThread = 1;
+
+    uint64_t *hist = (uint64_t *)calloc((size_t)nbThread * SORT_BUCKETS, sizeof(uint64_t));
+    uint64_t *bucketStart = (uint64_t *)malloc((SORT_BUCKETS + 1) * sizeof(uint64_t));
+    if (hist == NULL || bucketStart == NULL) {
+        printf("SortTargetFile: out of memory\n");
+        exit(1);
+    }
+    std::atomic<uint32_t> next(0);
+
+    SORT_PARAM *params = new SORT_PARAM[nbThread];
+    for (int t = 0; t < nbThread; t++) {
+        params[t].threadId = t;
+        params[t].nbThread = nbThread;
+        params[t].src = src;
+        params[t].dst = dst;
+        params[t].count = count;
+        params[t].len = len;
+        params[t].hist = hist;
+        params[t].bucketStart = bucketStart;
+        params[t].next = &next;
+    }
+
+    runThreads(histSlice, params, nbThread);
+
+    // Each thread scatters its slice at its own offsets in each bucket
+    uint64_t pos = 0;
+    for (uint32_t b = 0; b < SORT_BUCKETS; b++) {
+        bucketStart[b] = pos;
+        for (int t = 0; t < nbThread; t++) {
+            uint64_t n = hist[(uint64_t)t * SORT_BUCKETS + b];
+            hist[(uint64_t)t * SORT_BUCKETS + b] = pos;
+            pos += n;
+        }
+    }
+    bucketStart[SORT_BUCKETS] = pos;
+
+    runThreads(scatterSlice, params, nbThread);
+    runThreads(sortBuckets, params, nbThread);
+
+    delete[] params;
+    free(hist);
+    free(bucketStart);
+
+    uint64_t n = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        if (n == 0 || memcmp(dst + (n - 1) * len, dst + i * len, len) != 0) {
+            if (n != i)
+                memcpy(dst + n * len, dst + i * len, len);
+            n++;
+        }
+    }
+    return n;
+}
+
+static void writeFile(const std::string &fileName, const uint8_t *data, uint64_t size)
+{
+    FILE *f = fopen(fileName.c_str(), "wb");
+    if (f == NULL || fwrite(data, 1, (size_t)size, f) != size) {
+        printf("SortTargetFile: cannot write %s\n", fileName.c_str());
+        exit(1);
+    }
+    fclose(f);
+}
+
+static void replaceFile(const std::string &tmpName, const std::string &fileName)
+{
+#ifdef WIN64
+    if (!MoveFileExA(tmpName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+    if (rename(tmpName.c_str(), fileName.c_str()) != 0) {
+#endif
+        printf("Cannot replace %s\n", fileName.c_str());
+        exit(1);
+    }
+}
+
+// Buffered reader of a sorted run
+struct RunReader {
+    FILE *f;
+    char *buf;
+    uint8_t rec[32];
+    int id;
+};
+
+struct RunGreater {
+    int len;
+    bool operator()(const RunReader *a, const RunReader *b) const { return memcmp(a->rec, b->rec, len) > 0; }
+};
+
+uint64_t SortTargetFile(const std::string &fileName, int len, int nbThread, uint64_t memLimit)
+{
+    if (len != 20 && len != 32) {
+        printf("SortTargetFile: unsupported record length %d\n", len);
+        exit(1);
+    }
+
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (f == NULL) {
+        printf("%s can not open\n", fileName.c_str());
+        exit(1);
+    }
+#ifdef WIN64
+    _fseeki64(f, 0, SEEK_END);
+    uint64_t count = (uint64_t)_ftelli64(f) / len;
+#else
+    fseeko(f, 0, SEEK_END);
+    uint64_t count = (uint64_t)ftello(f) / len;
+#endif
+    rewind(f);
+
+    std::string tmpName = fileName + ".tmp";
+
+    // Records per run, a run needs its input and scatter buffers
+    uint64_t runSize = memLimit / (2 * (uint64_t)len);
+    if (runSize < 65536)
+        runSize = 65536;
+    uint64_t nbRun = (count + runSize - 1) / runSize;
+    if (nbRun == 0)
+        nbRun = 1;
+    if (runSize > count)
+        runSize = count;
+
+    uint8_t *src = (uint8_t *)malloc((size_t)(runSize * len) + 1);
+    uint8_t *dst = (uint8_t *)malloc((size_t)(runSize * len) + 1);
+    if (src == NULL || dst == NULL) {
+        printf("SortTargetFile: out of memory\n");
+        exit(1);
+    }
+
+    uint64_t total = 0;
+
+    if (nbRun == 1) {
+
+        if (fread(src, 1, (size_t)(count * len), f) != count * len) {
+            printf("SortTargetFile: cannot read %s\n", fileName.c_str());
+            exit(1);
+        }
+        fclose(f);
+        total = sortRecords(src, dst, count, len, nbThread);
+        free(src);
+        writeFile(tmpName, dst, total * len);
+        free(dst);
+
+    } else {
+
+        // Sorted runs
+        std::vector<std::string> runNames;
+        for (uint64_t r = 0; r < nbRun; r++) {
+            uint64_t n = std::min(runSize, count - r * runSize);
+            printf("\rSorting      : run %llu/%llu", (unsigned long long)(r + 1), (unsigned long long)nbRun);
+            fflush(stdout);
+            if (fread(src, 1, (size_t)(n * len), f) != n * len) {
+                printf("\nSortTargetFile: cannot read %s\n", fileName.c_str());
+                exit(1);
+            }
+            n = sortRecords(src, dst, n, len, nbThread);
+            runNames.push_back(fileName + ".run" + std::to_string(r));
+            writeFile(runNames.back(), dst, n * len);
+        }
+        printf("\n");
+        fclose(f);
+        free(src);
+        free(dst);
+
+        // K-way merge with dedup
+        RunGreater cmp;
+        cmp.len = len;
+        std::priority_queue<RunReader *, std::vector<RunReader *>, RunGreater> heap(cmp);
+        std::vector<RunReader> runs(runNames.size());
+        for (size_t r = 0; r < runNames.size(); r++) {
+            runs[r].f = fopen(runNames[r].c_str(), "rb");
+            runs[r].buf = (char *)malloc(MERGE_BUFFER);
+            runs[r].id = (int)r;
+            if (runs[r].f == NULL || runs[r].buf == NULL) {
+                printf("SortTargetFile: cannot open %s\n", runNames[r].c_str());
+                exit(1);
+            }
+            setvbuf(runs[r].f, runs[r].buf, _IOFBF, MERGE_BUFFER);
+            if (fread(runs[r].rec, 1, len, runs[r].f) == (size_t)len)
+                heap.push(&runs[r]);
+        }
+
+        FILE *out = fopen(tmpName.c_str(), "wb");
+        char *outBuf = (char *)malloc(MERGE_BUFFER);
+        if (out == NULL || outBuf == NULL) {
+            printf("SortTargetFile: cannot write %s\n", tmpName.c_str());
+            exit(1);
+        }
+        setvbuf(out, outBuf, _IOFBF, MERGE_BUFFER);
+
+        uint8_t last[32];
+        printf("Merging      : %llu runs\n", (unsigned long long)nbRun);
+        while (!heap.empty()) {
+            RunReader *r = heap.top();
+            heap.pop();
+            if (total == 0 || memcmp(last, r->rec, len) != 0) {
+                if (fwrite(r->rec, 1, len, out) != (size_t)len) {
+                    printf("SortTargetFile: cannot write %s\n", tmpName.c_str());
+                    exit(1);
+                }
+                memcpy(last, r->rec, len);
+                total++;
+            }
+            if (fread(r->rec, 1, len, r->f) == (size_t)len)
+                heap.push(r);
+        }
+        fclose(out);
+        free(outBuf);
+
+        for (size_t r = 0; r < runs.size(); r++) {
+            fclose(runs[r].f);
+            free(runs[r].buf);
+            remove(runNames[r].c_str());
+        }
+
+    }
+
+    replaceFile(tmpName, fileName);
+    return total;
+}
+
+// Buffered writer of the merged file, its chunks are hashed as they are
+// written (same hash as TargetsHash() of the file)
+struct HashWriter {
+    FILE *f;
+    uint8_t *buf;       // HASH_CHUNK bytes
+    uint64_t fill;
+    uint64_t chunk;
+    uint64_t size;
+    uint64_t hash;
+    bool ok;
+};
+
+static void flushChunk(HashWriter &w)
+{
+    if (w.fill == 0)
+        return;
+    w.hash += hashChunk(w.buf, w.fill, w.chunk++);
+    w.ok &= fwrite(w.buf, 1, (size_t)w.fill, w.f) == w.fill;
+    w.fill = 0;
+}
+
+static void putRecord(HashWriter &w, const uint8_t *r, int len)
+{
+    uint64_t n = std::min((uint64_t)len, HASH_CHUNK - w.fill);
+    memcpy(w.buf + w.fill, r, (size_t)n);
+    w.fill += n;
+    if (w.fill == HASH_CHUNK) {
+        flushChunk(w);
+        memcpy(w.buf, r + n, (size_t)(len - n));
+        w.fill = len - n;
+    }
+    w.size += len;
+}
+
+static void putAdded(HashWriter &w, const uint8_t *r, int len, std::vector<uint8_t> &inserted)
+{
+    putRecord(w, r, len);
+    inserted.insert(inserted.end(), r, r + len);
+}
+
+bool MergeTargetFile(const std::string &fileName, int len, const uint8_t *added, uint64_t nAdded,
+                     const uint8_t *removed, uint64_t nRemoved, std::vector<uint8_t> &inserted,
+                     std::vector<uint8_t> &dropped, MERGE_INFO *info)
+{
+    std::string tmpName = fileName + ".tmp";
+    FILE *f = fopen(fileName.c_str(), "rb");
+    if (f == NULL) {
+        printf("%s can not open\n", fileName.c_str());
+        exit(1);
+    }
+
+    HashWriter w;
+    w.f = fopen(tmpName.c_str(), "wb");
+    w.buf = (uint8_t *)malloc(HASH_CHUNK);
+    w.fill = 0;
+    w.chunk = 0;
+    w.size = 0;
+    w.hash = 0;
+    w.ok = true;
+    char *outBuf = (char *)malloc(MERGE_BUFFER);
+    uint8_t *in = (uint8_t *)malloc(HASH_CHUNK + 64);
+    if (w.f == NULL || w.buf == NULL || outBuf == NULL || in == NULL) {
+        printf("MergeTargetFile: cannot write %s\n", tmpName.c_str());
+        exit(1);
+    }
+    setvbuf(w.f, outBuf, _IOFBF, MERGE_BUFFER);
+
+    // The file is read by chunks of the content hash, a record may span two
+    uint64_t a = 0;
+    uint64_t r = 0;
+    uint64_t carry = 0;
+    uint64_t chunk = 0;
+    uint64_t oldSize = 0;
+    uint64_t oldHash = 0;
+    uint8_t last[32];
+    bool first = true;
+    bool sorted = true;
+    size_t n;
+    while (sorted && (n = fread(in + carry, 1, HASH_CHUNK, f)) > 0) {
+        oldHash += hashChunk(in + carry, n, chunk++);
+        oldSize += n;
+        uint64_t end = carry + n;
+        uint64_t i = 0;
+        for (; i + len <= end; i += len) {
+            const uint8_t *o = in + i;
+            if (!first && memcmp(last, o, len) >= 0) {
+                sorted = false;
+                break;
+            }
+            memcpy(last, o, len);
+            first = false;
+
+            while (a < nAdded && memcmp(added + a * len, o, len) < 0) {
+                putAdded(w, added + a * len, len, inserted);
+                a++;
+            }
+            if (a < nAdded && memcmp(added + a * len, o, len) == 0)
+                a++;
+
+            while (r < nRemoved && memcmp(removed + r * len, o, len) < 0)
+                r++;
+            if (r < nRemoved && memcmp(removed + r * len, o, len) == 0) {
+                dropped.insert(dropped.end(), o, o + len);
+                r++;
+                continue;
+            }
+            putRecord(w, o, len);
+        }
+        carry = end - i;
+        memmove(in, in + i, (size_t)carry);
+    }
+    fclose(f);
+    free(in);
+
+    if (sorted) {
+        for (; a < nAdded; a++)
+            putAdded(w, added + a * len, len, inserted);
+        flushChunk(w);
+    }
+    w.ok &= fclose(w.f) == 0;
+    free(w.buf);
+    free(outBuf);
+
+    if (!sorted) {
+        remove(tmpName.c_str());
+        inserted.clear();
+        dropped.clear();
+        return false;
+    }
+    if (!w.ok) {
+        printf("MergeTargetFile: cannot write %s\n", tmpName.c_str());
+        remove(tmpName.c_str());
+        exit(1);
+    }
+
+    info->oldSize = oldSize;
+    info->oldHash = mix64(oldSize) + oldHash;
+    info->size = w.size;
+    info->hash = mix64(w.size) + w.hash;
+    return true;
+}
+
+void ReplaceTargetFile(const std::string &fileName)
+{
+    replaceFile(fileName + ".tmp", fileName);
+}
+
+uint64_t SortMemoryLimit()
+{
+#ifdef WIN64
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    GlobalMemoryStatusEx(&status);
+    return (uint64_t)status.ullTotalPhys / 2;
+#else
+    return (uint64_t)sysconf(_SC_PHYS_PAGES) * (uint64_t)sysconf(_SC_PAGE_SIZE) / 2;
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef TARGETSORT_H
+#define TARGETSORT_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Ingest of raw target files (hash160 or x point records). The lookups need
+// the records sorted in memcmp order without duplicates; unsorted files are
+// sorted and deduplicated once and written back in place for reuse.
+
+// Return true if the records are strictly increasing
+bool TargetsSorted(const uint8_t *data, uint64_t count, int len, int nbThread);
+
+// Content hash of the target file (size bytes), independent of nbThread
+uint64_t TargetsHash(const uint8_t *data, uint64_t size, int nbThread);
+
+// Sort and dedup the file in place. Files fitting in memLimit bytes (input
+// and scatter buffer) are radix sorted in memory, larger ones are split in
+// sorted runs merged from disk. Return the number of records written.
+uint64_t SortTargetFile(const std::string &fileName, int len, int nbThread, uint64_t memLimit);
+
+// Fingerprints of the target file before and after MergeTargetFile()
+typedef struct {
+    uint64_t oldSize;
+    uint64_t oldHash;   // TargetsHash() of the file before the merge
+    uint64_t size;
+    uint64_t hash;      // TargetsHash() of the merged file
+} MERGE_INFO;
+
+// Merge the sorted added records in the sorted target file and drop the
+// removed ones in one streaming pass, to <file>.tmp. The records actually
+// inserted and dropped are appended to inserted and dropped. Return false,
+// nothing written, when the target file is not sorted. The merged file
+// replaces the target file with ReplaceTargetFile().
+bool MergeTargetFile(const std::string &fileName, int len, const uint8_t *added, uint64_t nAdded,
+                     const uint8_t *removed, uint64_t nRemoved, std::vector<uint8_t> &inserted,
+                     std::vector<uint8_t> &dropped, MERGE_INFO *info);
+void ReplaceTargetFile(const std::string &fileName);
+
+// Memory budget of the sort, half of the physical memory
+uint64_t SortMemoryLimit();
+
+#endif // TARGETSORT_H
@@ -0,0 +1,189 @@
+#include "TargetTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <emmintrin.h>
+
+// Both 32 bits halves are biased so that signed SSE2 compares order them as unsigned
+#define TREE_BIAS 0x8000000080000000ULL
+
+// Padding key, the largest biased value
+#define TREE_INF (0xFFFFFFFFFFFFFFFFULL ^ TREE_BIAS)
+
+TargetTree::TargetTree(const uint8_t *data, uint64_t count, int len)
+{
+    _data = data;
+    _count = count;
+    _len = len;
+
+    if (count == 0) {
+        printf("Target tree init error\n");
+        exit(1);
+    }
+
+    // Layers sizes, from the leaves to the root (a single node)
+    _height = 1;
+    for (uint64_t n = count; n > TREE_B; n = prev_keys(n))
+        _height++;
+    _size = 0;
+    uint64_t n = count;
+    for (int h = 0; h < _height; h++) {
+        _offset[h] = _size;
+        _size += blocks(n) * TREE_B;
+        n = prev_keys(n);
+    }
+    _offset[_height] = _size;
+
+    _tree = (uint64_t *)_mm_malloc((size_t)_size * sizeof(uint64_t), 64);
+    if (_tree == NULL) {
+        printf("Target tree init error\n");
+        exit(1);
+    }
+
+    for (uint64_t i = 0; i < count; i++)
+        _tree[i] = prefix(data + i * len);
+    for (uint64_t i = count; i < _offset[1]; i++)
+        _tree[i] = TREE_INF;
+
+    // Key j of node k of layer h is the smallest key of its child j+1,
+    // that is the first key of the leftmost leaf below that child
+    for (int h = 1; h < _height; h++) {
+        for (uint64_t i = 0; i < _offset[h + 1] - _offset[h]; i++) {
+            uint64_t k = i / TREE_B;
+            uint64_t j = i - k * TREE_B;
+            k = k * (TREE_B + 1) + j + 1;
+            for (int l = 1; l < h; l++)
+                k *= (TREE_B + 1);
+            _tree[_offset[h] + i] = (k * TREE_B < count) ? _tree[k * TREE_B] : TREE_INF;
+        }
+    }
+}
+
+TargetTree::~TargetTree()
+{
+    _mm_free(_tree);
+}
+
+uint64_t TargetTree::blocks(uint64_t n)
+{
+    return (n + TREE_B - 1) / TREE_B;
+}
+
+uint64_t TargetTree::prev_keys(uint64_t n)
+{
+    return (blocks(n) + TREE_B) / (TREE_B + 1) * TREE_B;
+}
+
+uint64_t TargetTree::prefix(const uint8_t *key)
+{
+    uint64_t p = 0;
+    for (int i = 0; i < 8; i++)
+        p = (p << 8) | key[i];
+    return p ^ TREE_BIAS;
+}
+
+// Number of keys of the node lower than x (64 bits unsigned compares
+// built from the 32 bits signed ones of SSE2)
+static inline uint32_t node_rank(__m128i x, const uint64_t *node)
+{
+    uint32_t r = 0;
+    for (int i = 0; i < TREE_B / 2; i++) {
+        __m128i k = _mm_load_si128((const __m128i *)node + i);
+        __m128i gt = _mm_cmpgt_epi32(x, k);
+        __m128i eq = _mm_cmpeq_epi32(x, k);
+        __m128i hiGt = _mm_shuffle_epi32(gt, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i hiEq = _mm_shuffle_epi32(eq, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128i loGt = _mm_shuffle_epi32(gt, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128i lt = _mm_or_si128(hiGt, _mm_and_si128(hiEq, loGt));
+        int m = _mm_movemask_pd(_mm_castsi128_pd(lt));
+        r += (m & 1) + (m >> 1);
+    }
+    return r;
+}
+
+// Index of the first leaf key >= x
+uint64_t TargetTree::lower_bound(uint64_t x) const
+{
+    __m128i vx = _mm_set1_epi64x((long long)x);
+    uint64_t k = 0;
+    for (int h = _height - 1; h > 0; h--) {
+        const uint64_t *node = _tree + _offset[h] + k * TREE_B;
+        k = k * (TREE_B + 1) + node_rank(vx, node);
+    }
+    return k * TREE_B + node_rank(vx, _tree + k * TREE_B);
+}
+
+// Full compare of the records from leaf i with the prefix x of key
+bool TargetTree::match(const uint8_t *key, uint64_t x, uint64_t i) const
+{
+    for (; i < _count && _tree[i] == x; i++) {
+        if (memcmp(key, _data + i * _len, _len) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool TargetTree::find(const uint8_t *key) const
+{
+    uint64_t x = prefix(key);
+    return match(key, x, lower_bound(x));
+}
+
+// Same result as find() for the n keys whose hit is set, hit is cleared
+// for the others. TREE_BATCH keys go down the tree a layer at a time and
+// the node each one moves to is prefetched while the others descend, so
+// their cache misses overlap instead of being waited one by one.
+void TargetTree::find_batch(const uint8_t *keys, int n, uint8_t *hit) const
+{
+    uint64_t x[TREE_BATCH];
+    uint64_t k[TREE_BATCH];
+
+    for (int b = 0; b < n; b += TREE_BATCH) {
+
+        int m = (n - b < TREE_BATCH) ? n - b : TREE_BATCH;
+        const uint8_t *key = keys + (uint64_t)b * _len;
+        uint8_t *h = hit + b;
+
+        for (int i = 0; i < m; i++) {
+            x[i] = prefix(key + i * _len);
+            k[i] = 0;
+        }
+
+        for (int l = _height - 1; l > 0; l--) {
+            const uint64_t *layer = _tree + _offset[l];
+            const uint64_t *next = _tree + _offset[l - 1];
+            for (int i = 0; i < m; i++) {
+                if (!h[i])
+                    continue;
+                __m128i vx = _mm_set1_epi64x((long long)x[i]);
+                k[i] = k[i] * (TREE_B + 1) + node_rank(vx, layer + k[i] * TREE_B);
+                _mm_prefetch((const char *)(next + k[i] * TREE_B), _MM_HINT_T0);
+            }
+        }
+
+        // Leaves, then the records to compare
+        for (int i = 0; i < m; i++) {
+            if (!h[i])
+                continue;
+            __m128i vx = _mm_set1_epi64x((long long)x[i]);
+            k[i] = k[i] * TREE_B + node_rank(vx, _tree + k[i] * TREE_B);
+            if (k[i] < _count && _tree[k[i]] == x[i])
+                _mm_prefetch((const char *)(_data + k[i] * _len), _MM_HINT_T0);
+        }
+
+        for (int i = 0; i < m; i++) {
+            if (h[i])
+                h[i] = match(key + i * _len, x[i], k[i]) ? 1 : 0;
+        }
+
+    }
+}
+
+void TargetTree::print()
+{
+    printf("S+ tree at %p\n", (void *)this);
+    printf("  Entries    : %llu\n", (unsigned long long)_count);
+    printf("  Height     : %d (%d keys per node)\n", _height, TREE_B);
+    printf("  Bytes      : %llu", (unsigned long long)(_size * sizeof(uint64_t)));
+    printf(" (%llu MB)\n", (unsigned long long)(_size * sizeof(uint64_t) / (1024 * 1024)));
+}
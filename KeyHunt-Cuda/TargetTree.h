@@ -0,0 +1,46 @@
+#ifndef TARGETTREE_H
+#define TARGETTREE_H
+
+#include <stdint.h>
+
+// Filter format following the fuse filters (see FuseFilter.h), CPU only
+#define FILTER_TREE 4   // exact S+ tree over the target prefixes, no Bloom filter
+
+// Keys per node, one cache line of 64 bits keys
+#define TREE_B 8
+
+// Keys descended side by side by find_batch()
+#define TREE_BATCH 16
+
+// Static S+ tree (B+ tree in implicit layout) over the big endian 64 bits
+// prefixes of the sorted target array. The leaf layer is the sorted prefix
+// array itself, so the lower bound found by the descent is the rank of the
+// candidate record in the target array, which is then compared in full.
+// Lookups are exact, there is no false positive to recheck.
+class TargetTree
+{
+public:
+    TargetTree(const uint8_t *data, uint64_t count, int len);
+    ~TargetTree();
+    bool find(const uint8_t *key) const;
+    void find_batch(const uint8_t *keys, int n, uint8_t *hit) const;
+    void print();
+
+private:
+    uint64_t lower_bound(uint64_t x) const;
+    bool match(const uint8_t *key, uint64_t x, uint64_t i) const;
+    static uint64_t prefix(const uint8_t *key);
+    static uint64_t blocks(uint64_t n);
+    static uint64_t prev_keys(uint64_t n);
+
+private:
+    const uint8_t *_data;
+    uint64_t _count;
+    int _len;
+    int _height;
+    uint64_t _offset[64];   // start of each layer, leaves first
+    uint64_t _size;         // number of keys of all layers
+    uint64_t *_tree;        // biased keys, see prefix()
+};
+
+#endif // TARGETTREE_H
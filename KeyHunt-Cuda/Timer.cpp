@@ -170,8 +170,8 @@ int Timer::getCoreNumber()
     GetSystemInfo(&sysinfo);
     return sysinfo.dwNumberOfProcessors;
 #else
-    // TODO
-    return 1;
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
 #endif
 
 }
@@ -0,0 +1,106 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CPUIDH
+#define CPUIDH
+
+#include <stdint.h>
+
+#ifdef WIN64
+#include <intrin.h>
+#endif
+
+// Runtime detection of the instruction sets used by the wide hash kernels.
+// The binary is built for SSSE3, wider kernels are compiled separately and
+// must only be called when both the CPU and the OS (XCR0) support them.
+
+static inline void cpuid_query(uint32_t leaf, uint32_t subleaf, uint32_t r[4])
+{
+#ifdef WIN64
+    int regs[4];
+    __cpuidex(regs, (int)leaf, (int)subleaf);
+    r[0] = (uint32_t)regs[0];
+    r[1] = (uint32_t)regs[1];
+    r[2] = (uint32_t)regs[2];
+    r[3] = (uint32_t)regs[3];
+#else
+    __asm__ __volatile__("cpuid"
+                         : "=a"(r[0]), "=b"(r[1]), "=c"(r[2]), "=d"(r[3])
+                         : "a"(leaf), "c"(subleaf));
+#endif
+}
+
+static inline uint64_t cpuid_xgetbv()
+{
+#ifdef WIN64
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static inline bool cpu_has_avx2()
+{
+    uint32_t r[4];
+    cpuid_query(0, 0, r);
+    if (r[0] < 7)
+        return false;
+    cpuid_query(1, 0, r);
+    // OSXSAVE and AVX
+    if ((r[2] & (1 << 27)) == 0 || (r[2] & (1 << 28)) == 0)
+        return false;
+    // XMM and YMM state enabled by the OS
+    if ((cpuid_xgetbv() & 0x6) != 0x6)
+        return false;
+    cpuid_query(7, 0, r);
+    return (r[1] & (1 << 5)) != 0;
+}
+
+static inline bool cpu_has_avx512()
+{
+    uint32_t r[4];
+    cpuid_query(0, 0, r);
+    if (r[0] < 7)
+        return false;
+    cpuid_query(1, 0, r);
+    if ((r[2] & (1 << 27)) == 0)
+        return false;
+    // XMM, YMM, opmask and ZMM state enabled by the OS
+    if ((cpuid_xgetbv() & 0xE6) != 0xE6)
+        return false;
+    cpuid_query(7, 0, r);
+    // AVX512F
+    return (r[1] & (1 << 16)) != 0;
+}
+
+static inline bool cpu_has_sha()
+{
+    uint32_t r[4];
+    cpuid_query(0, 0, r);
+    if (r[0] < 7)
+        return false;
+    cpuid_query(1, 0, r);
+    // SSE4.1 (blend) is used by the SHA-NI kernel
+    if ((r[2] & (1 << 19)) == 0)
+        return false;
+    cpuid_query(7, 0, r);
+    return (r[1] & (1 << 29)) != 0;
+}
+
+#endif // CPUIDH
@@ -0,0 +1,803 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "ripemd160.h"
+#include "sha256.h"
+#include <immintrin.h>
+#include <string.h>
+#include <stdint.h>
+
+// Fused SHA256 + RIPEMD160 of 16 public keys using AVX-512F.
+// The SHA256 digests stay in ZMM registers and are directly used as the
+// RIPEMD160 message (32 bytes + constant padding block).
+
+namespace _hash160avx512
+{
+
+#define SET16(a) a, a, a, a, a, a, a, a, a, a, a, a, a, a, a, a
+
+#ifdef WIN64
+static const __declspec(align(64)) uint32_t _shainit[] = {
+#else
+static const uint32_t _shainit[] __attribute__((aligned(64))) = {
+#endif
+    SET16(0x6a09e667),
+    SET16(0xbb67ae85),
+    SET16(0x3c6ef372),
+    SET16(0xa54ff53a),
+    SET16(0x510e527f),
+    SET16(0x9b05688c),
+    SET16(0x1f83d9ab),
+    SET16(0x5be0cd19)
+};
+
+#ifdef WIN64
+static const __declspec(align(64)) uint32_t _ripinit[] = {
+#else
+static const uint32_t _ripinit[] __attribute__((aligned(64))) = {
+#endif
+    SET16(0x67452301ul),
+    SET16(0xEFCDAB89ul),
+    SET16(0x98BADCFEul),
+    SET16(0x10325476ul),
+    SET16(0xC3D2E1F0ul)
+};
+
+// Boolean functions are single ternary logic instructions
+#define Maj(b,c,d) _mm512_ternarylogic_epi32(b, c, d, 0xE8)
+#define Ch(b,c,d)  _mm512_ternarylogic_epi32(b, c, d, 0xCA)
+#define ROR(x,n)   _mm512_ror_epi32(x, n)
+#define ROL(x,n)   _mm512_rol_epi32(x, n)
+#define SHR(x,n)   _mm512_srli_epi32(x, n)
+#define XOR3(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+
+/* SHA256 Functions */
+#define S0(x) XOR3(ROR((x), 2), ROR((x), 13), ROR((x), 22))
+#define S1(x) XOR3(ROR((x), 6), ROR((x), 11), ROR((x), 25))
+#define s0(x) XOR3(ROR((x), 7), ROR((x), 18), SHR((x), 3))
+#define s1(x) XOR3(ROR((x), 17), ROR((x), 19), SHR((x), 10))
+
+#define add3(x0, x1, x2 ) _mm512_add_epi32(_mm512_add_epi32(x0, x1), x2)
+#define add4(x0, x1, x2, x3) _mm512_add_epi32(_mm512_add_epi32(x0, x1), _mm512_add_epi32(x2, x3))
+#define add5(x0, x1, x2, x3, x4) _mm512_add_epi32(add3(x0, x1, x2), _mm512_add_epi32(x3, x4))
+
+#define Round(a, b, c, d, e, f, g, h, i, w)                 \
+    T1 = add5(h, S1(e), Ch(e, f, g), _mm512_set1_epi32(i), w);  \
+    d = _mm512_add_epi32(d, T1);                            \
+    T2 = _mm512_add_epi32(S0(a), Maj(a, b, c));             \
+    h = _mm512_add_epi32(T1, T2);
+
+// Round with a constant message word, w is folded into the constant i
+#define RoundK(a, b, c, d, e, f, g, h, i)                   \
+    T1 = add4(h, S1(e), Ch(e, f, g), _mm512_set1_epi32(i));     \
+    d = _mm512_add_epi32(d, T1);                               \
+    T2 = _mm512_add_epi32(S0(a), Maj(a, b, c));                \
+    h = _mm512_add_epi32(T1, T2);
+
+#define WMIX() \
+  w0 = add4(s1(w14), w9, s0(w1), w0); \
+  w1 = add4(s1(w15), w10, s0(w2), w1); \
+  w2 = add4(s1(w0), w11, s0(w3), w2); \
+  w3 = add4(s1(w1), w12, s0(w4), w3); \
+  w4 = add4(s1(w2), w13, s0(w5), w4); \
+  w5 = add4(s1(w3), w14, s0(w6), w5); \
+  w6 = add4(s1(w4), w15, s0(w7), w6); \
+  w7 = add4(s1(w5), w0, s0(w8), w7); \
+  w8 = add4(s1(w6), w1, s0(w9), w8); \
+  w9 = add4(s1(w7), w2, s0(w10), w9); \
+  w10 = add4(s1(w8), w3, s0(w11), w10); \
+  w11 = add4(s1(w9), w4, s0(w12), w11); \
+  w12 = add4(s1(w10), w5, s0(w13), w12); \
+  w13 = add4(s1(w11), w6, s0(w14), w13); \
+  w14 = add4(s1(w12), w7, s0(w15), w14); \
+  w15 = add4(s1(w13), w8, s0(w0), w15);
+
+// First message schedule of a 33 byte message, w9..w14 = 0 and w15 = 0x108
+#define WMIX33() \
+  w0 = _mm512_add_epi32(s0(w1), w0); \
+  w1 = add3(_mm512_set1_epi32(0x00A50000), s0(w2), w1); \
+  w2 = add3(s1(w0), s0(w3), w2); \
+  w3 = add3(s1(w1), s0(w4), w3); \
+  w4 = add3(s1(w2), s0(w5), w4); \
+  w5 = add3(s1(w3), s0(w6), w5); \
+  w6 = add4(s1(w4), _mm512_set1_epi32(0x108), s0(w7), w6); \
+  w7 = add4(s1(w5), w0, s0(w8), w7); \
+  w8 = add3(s1(w6), w1, w8); \
+  w9 = _mm512_add_epi32(s1(w7), w2); \
+  w10 = _mm512_add_epi32(s1(w8), w3); \
+  w11 = _mm512_add_epi32(s1(w9), w4); \
+  w12 = _mm512_add_epi32(s1(w10), w5); \
+  w13 = _mm512_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm512_set1_epi32(0x10420023)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm512_set1_epi32(0x108));
+
+// First message schedule of the second block of a 65 byte message,
+// w1..w14 = 0 and w15 = 0x208 (w0 is unchanged)
+#define WMIX65() \
+  w1 = _mm512_set1_epi32(0x01450000); \
+  w2 = s1(w0); \
+  w3 = _mm512_set1_epi32(0x200051CA); \
+  w4 = s1(w2); \
+  w5 = _mm512_set1_epi32(0x22D45414); \
+  w6 = _mm512_add_epi32(s1(w4), _mm512_set1_epi32(0x208)); \
+  w7 = _mm512_add_epi32(w0, _mm512_set1_epi32(0xA0802025)); \
+  w8 = _mm512_add_epi32(s1(w6), _mm512_set1_epi32(0x01450000)); \
+  w9 = _mm512_add_epi32(s1(w7), w2); \
+  w10 = _mm512_add_epi32(s1(w8), _mm512_set1_epi32(0x200051CA)); \
+  w11 = _mm512_add_epi32(s1(w9), w4); \
+  w12 = _mm512_add_epi32(s1(w10), _mm512_set1_epi32(0x22D45414)); \
+  w13 = _mm512_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm512_set1_epi32(0x10820045)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm512_set1_epi32(0x208));
+
+#define LOADW(i) _mm512_setr_epi32(blk[0][o + i], blk[1][o + i], blk[2][o + i], blk[3][o + i], \
+                                   blk[4][o + i], blk[5][o + i], blk[6][o + i], blk[7][o + i], \
+                                   blk[8][o + i], blk[9][o + i], blk[10][o + i], blk[11][o + i], \
+                                   blk[12][o + i], blk[13][o + i], blk[14][o + i], blk[15][o + i])
+
+// 16 SHA256 blocks in parallel, o is the word offset of the block in the messages
+void Sha256Transform(__m512i *s, uint32_t *blk[16], int o)
+{
+    __m512i a, b, c, d, e, f, g, h;
+    __m512i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m512i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m512i T1, T2;
+
+    a = s[0];
+    b = s[1];
+    c = s[2];
+    d = s[3];
+    e = s[4];
+    f = s[5];
+    g = s[6];
+    h = s[7];
+
+    w0 = LOADW(0);
+    w1 = LOADW(1);
+    w2 = LOADW(2);
+    w3 = LOADW(3);
+    w4 = LOADW(4);
+    w5 = LOADW(5);
+    w6 = LOADW(6);
+    w7 = LOADW(7);
+    w8 = LOADW(8);
+    w9 = LOADW(9);
+    w10 = LOADW(10);
+    w11 = LOADW(11);
+    w12 = LOADW(12);
+    w13 = LOADW(13);
+    w14 = LOADW(14);
+    w15 = LOADW(15);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    Round(h, a, b, c, d, e, f, g, 0x71374491, w1);
+    Round(g, h, a, b, c, d, e, f, 0xB5C0FBCF, w2);
+    Round(f, g, h, a, b, c, d, e, 0xE9B5DBA5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x3956C25B, w4);
+    Round(d, e, f, g, h, a, b, c, 0x59F111F1, w5);
+    Round(c, d, e, f, g, h, a, b, 0x923F82A4, w6);
+    Round(b, c, d, e, f, g, h, a, 0xAB1C5ED5, w7);
+    Round(a, b, c, d, e, f, g, h, 0xD807AA98, w8);
+    Round(h, a, b, c, d, e, f, g, 0x12835B01, w9);
+    Round(g, h, a, b, c, d, e, f, 0x243185BE, w10);
+    Round(f, g, h, a, b, c, d, e, 0x550C7DC3, w11);
+    Round(e, f, g, h, a, b, c, d, 0x72BE5D74, w12);
+    Round(d, e, f, g, h, a, b, c, 0x80DEB1FE, w13);
+    Round(c, d, e, f, g, h, a, b, 0x9BDC06A7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC19BF174, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    Round(h, a, b, c, d, e, f, g, 0xEFBE4786, w1);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    Round(f, g, h, a, b, c, d, e, 0x240CA1CC, w3);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4A7484AA, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm512_add_epi32(a, s[0]);
+    s[1] = _mm512_add_epi32(b, s[1]);
+    s[2] = _mm512_add_epi32(c, s[2]);
+    s[3] = _mm512_add_epi32(d, s[3]);
+    s[4] = _mm512_add_epi32(e, s[4]);
+    s[5] = _mm512_add_epi32(f, s[5]);
+    s[6] = _mm512_add_epi32(g, s[6]);
+    s[7] = _mm512_add_epi32(h, s[7]);
+
+}
+
+// 16 SHA256 of padded 33 byte messages (compressed keys)
+void Sha256Transform33(__m512i *s, uint32_t *blk[16], int o)
+{
+    __m512i a, b, c, d, e, f, g, h;
+    __m512i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m512i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m512i T1, T2;
+
+    a = s[0];
+    b = s[1];
+    c = s[2];
+    d = s[3];
+    e = s[4];
+    f = s[5];
+    g = s[6];
+    h = s[7];
+
+    w0 = LOADW(0);
+    w1 = LOADW(1);
+    w2 = LOADW(2);
+    w3 = LOADW(3);
+    w4 = LOADW(4);
+    w5 = LOADW(5);
+    w6 = LOADW(6);
+    w7 = LOADW(7);
+    w8 = LOADW(8);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    Round(h, a, b, c, d, e, f, g, 0x71374491, w1);
+    Round(g, h, a, b, c, d, e, f, 0xB5C0FBCF, w2);
+    Round(f, g, h, a, b, c, d, e, 0xE9B5DBA5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x3956C25B, w4);
+    Round(d, e, f, g, h, a, b, c, 0x59F111F1, w5);
+    Round(c, d, e, f, g, h, a, b, 0x923F82A4, w6);
+    Round(b, c, d, e, f, g, h, a, 0xAB1C5ED5, w7);
+    Round(a, b, c, d, e, f, g, h, 0xD807AA98, w8);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF27C);
+
+    WMIX33()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    Round(h, a, b, c, d, e, f, g, 0xEFBE4786, w1);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    Round(f, g, h, a, b, c, d, e, 0x240CA1CC, w3);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4A7484AA, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm512_add_epi32(a, s[0]);
+    s[1] = _mm512_add_epi32(b, s[1]);
+    s[2] = _mm512_add_epi32(c, s[2]);
+    s[3] = _mm512_add_epi32(d, s[3]);
+    s[4] = _mm512_add_epi32(e, s[4]);
+    s[5] = _mm512_add_epi32(f, s[5]);
+    s[6] = _mm512_add_epi32(g, s[6]);
+    s[7] = _mm512_add_epi32(h, s[7]);
+
+}
+
+// Second block of 16 padded 65 byte messages (uncompressed keys), o = 16
+void Sha256Transform65(__m512i *s, uint32_t *blk[16], int o)
+{
+    __m512i a, b, c, d, e, f, g, h;
+    __m512i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m512i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m512i T1, T2;
+
+    a = s[0];
+    b = s[1];
+    c = s[2];
+    d = s[3];
+    e = s[4];
+    f = s[5];
+    g = s[6];
+    h = s[7];
+
+    w0 = LOADW(0);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0x71374491);
+    RoundK(g, h, a, b, c, d, e, f, 0xB5C0FBCF);
+    RoundK(f, g, h, a, b, c, d, e, 0xE9B5DBA5);
+    RoundK(e, f, g, h, a, b, c, d, 0x3956C25B);
+    RoundK(d, e, f, g, h, a, b, c, 0x59F111F1);
+    RoundK(c, d, e, f, g, h, a, b, 0x923F82A4);
+    RoundK(b, c, d, e, f, g, h, a, 0xAB1C5ED5);
+    RoundK(a, b, c, d, e, f, g, h, 0xD807AA98);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF37C);
+
+    WMIX65()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0xF1034786);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    RoundK(f, g, h, a, b, c, d, e, 0x440CF396);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    RoundK(d, e, f, g, h, a, b, c, 0x6D48D8BE);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm512_add_epi32(a, s[0]);
+    s[1] = _mm512_add_epi32(b, s[1]);
+    s[2] = _mm512_add_epi32(c, s[2]);
+    s[3] = _mm512_add_epi32(d, s[3]);
+    s[4] = _mm512_add_epi32(e, s[4]);
+    s[5] = _mm512_add_epi32(f, s[5]);
+    s[6] = _mm512_add_epi32(g, s[6]);
+    s[7] = _mm512_add_epi32(h, s[7]);
+
+}
+
+#undef Round
+
+//#define f1(x, y, z) (x ^ y ^ z)
+//#define f2(x, y, z) ((x & y) | (~x & z))
+//#define f3(x, y, z) ((x | ~y) ^ z)
+//#define f4(x, y, z) ((x & z) | (~z & y))
+//#define f5(x, y, z) (x ^ (y | ~z))
+
+#define f1(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define f2(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0xCA)
+#define f3(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0x59)
+#define f4(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0xE4)
+#define f5(x,y,z) _mm512_ternarylogic_epi32(x, y, z, 0x2D)
+
+#define Round(a,b,c,d,e,f,x,k,r) \
+  u = add4(a,f,x,_mm512_set1_epi32(k)); \
+  a = _mm512_add_epi32(ROL(u, r),e); \
+  c = ROL(c, 10);
+
+#define R11(a,b,c,d,e,x,r) Round(a, b, c, d, e, f1(b, c, d), x, 0, r)
+#define R21(a,b,c,d,e,x,r) Round(a, b, c, d, e, f2(b, c, d), x, 0x5A827999ul, r)
+#define R31(a,b,c,d,e,x,r) Round(a, b, c, d, e, f3(b, c, d), x, 0x6ED9EBA1ul, r)
+#define R41(a,b,c,d,e,x,r) Round(a, b, c, d, e, f4(b, c, d), x, 0x8F1BBCDCul, r)
+#define R51(a,b,c,d,e,x,r) Round(a, b, c, d, e, f5(b, c, d), x, 0xA953FD4Eul, r)
+#define R12(a,b,c,d,e,x,r) Round(a, b, c, d, e, f5(b, c, d), x, 0x50A28BE6ul, r)
+#define R22(a,b,c,d,e,x,r) Round(a, b, c, d, e, f4(b, c, d), x, 0x5C4DD124ul, r)
+#define R32(a,b,c,d,e,x,r) Round(a, b, c, d, e, f3(b, c, d), x, 0x6D703EF3ul, r)
+#define R42(a,b,c,d,e,x,r) Round(a, b, c, d, e, f2(b, c, d), x, 0x7A6D76E9ul, r)
+#define R52(a,b,c,d,e,x,r) Round(a, b, c, d, e, f1(b, c, d), x, 0, r)
+
+// Big endian SHA256 words to little endian RIPEMD160 words (AVX-512F only, no byte shuffle)
+#define BSWAP(x) _mm512_ternarylogic_epi32(ROL(x, 8), ROR(x, 8), _mm512_set1_epi32(0x00FF00FF), 0xE4)
+
+// RIPEMD160 of the 16 SHA256 states s
+void Ripemd160Transform(__m512i *r, __m512i *s)
+{
+
+    __m512i a1 = _mm512_load_si512(_ripinit + 0);
+    __m512i b1 = _mm512_load_si512(_ripinit + 16);
+    __m512i c1 = _mm512_load_si512(_ripinit + 32);
+    __m512i d1 = _mm512_load_si512(_ripinit + 48);
+    __m512i e1 = _mm512_load_si512(_ripinit + 64);
+    __m512i a2 = a1;
+    __m512i b2 = b1;
+    __m512i c2 = c1;
+    __m512i d2 = d1;
+    __m512i e2 = e1;
+    __m512i u;
+    __m512i w[16];
+
+    w[0] = BSWAP(s[0]);
+    w[1] = BSWAP(s[1]);
+    w[2] = BSWAP(s[2]);
+    w[3] = BSWAP(s[3]);
+    w[4] = BSWAP(s[4]);
+    w[5] = BSWAP(s[5]);
+    w[6] = BSWAP(s[6]);
+    w[7] = BSWAP(s[7]);
+    w[8] = _mm512_set1_epi32(0x80);
+    w[9] = _mm512_setzero_si512();
+    w[10] = _mm512_setzero_si512();
+    w[11] = _mm512_setzero_si512();
+    w[12] = _mm512_setzero_si512();
+    w[13] = _mm512_setzero_si512();
+    w[14] = _mm512_set1_epi32(32 << 3);
+    w[15] = _mm512_setzero_si512();
+
+    R11(a1, b1, c1, d1, e1, w[0], 11);
+    R12(a2, b2, c2, d2, e2, w[5], 8);
+    R11(e1, a1, b1, c1, d1, w[1], 14);
+    R12(e2, a2, b2, c2, d2, w[14], 9);
+    R11(d1, e1, a1, b1, c1, w[2], 15);
+    R12(d2, e2, a2, b2, c2, w[7], 9);
+    R11(c1, d1, e1, a1, b1, w[3], 12);
+    R12(c2, d2, e2, a2, b2, w[0], 11);
+    R11(b1, c1, d1, e1, a1, w[4], 5);
+    R12(b2, c2, d2, e2, a2, w[9], 13);
+    R11(a1, b1, c1, d1, e1, w[5], 8);
+    R12(a2, b2, c2, d2, e2, w[2], 15);
+    R11(e1, a1, b1, c1, d1, w[6], 7);
+    R12(e2, a2, b2, c2, d2, w[11], 15);
+    R11(d1, e1, a1, b1, c1, w[7], 9);
+    R12(d2, e2, a2, b2, c2, w[4], 5);
+    R11(c1, d1, e1, a1, b1, w[8], 11);
+    R12(c2, d2, e2, a2, b2, w[13], 7);
+    R11(b1, c1, d1, e1, a1, w[9], 13);
+    R12(b2, c2, d2, e2, a2, w[6], 7);
+    R11(a1, b1, c1, d1, e1, w[10], 14);
+    R12(a2, b2, c2, d2, e2, w[15], 8);
+    R11(e1, a1, b1, c1, d1, w[11], 15);
+    R12(e2, a2, b2, c2, d2, w[8], 11);
+    R11(d1, e1, a1, b1, c1, w[12], 6);
+    R12(d2, e2, a2, b2, c2, w[1], 14);
+    R11(c1, d1, e1, a1, b1, w[13], 7);
+    R12(c2, d2, e2, a2, b2, w[10], 14);
+    R11(b1, c1, d1, e1, a1, w[14], 9);
+    R12(b2, c2, d2, e2, a2, w[3], 12);
+    R11(a1, b1, c1, d1, e1, w[15], 8);
+    R12(a2, b2, c2, d2, e2, w[12], 6);
+
+    R21(e1, a1, b1, c1, d1, w[7], 7);
+    R22(e2, a2, b2, c2, d2, w[6], 9);
+    R21(d1, e1, a1, b1, c1, w[4], 6);
+    R22(d2, e2, a2, b2, c2, w[11], 13);
+    R21(c1, d1, e1, a1, b1, w[13], 8);
+    R22(c2, d2, e2, a2, b2, w[3], 15);
+    R21(b1, c1, d1, e1, a1, w[1], 13);
+    R22(b2, c2, d2, e2, a2, w[7], 7);
+    R21(a1, b1, c1, d1, e1, w[10], 11);
+    R22(a2, b2, c2, d2, e2, w[0], 12);
+    R21(e1, a1, b1, c1, d1, w[6], 9);
+    R22(e2, a2, b2, c2, d2, w[13], 8);
+    R21(d1, e1, a1, b1, c1, w[15], 7);
+    R22(d2, e2, a2, b2, c2, w[5], 9);
+    R21(c1, d1, e1, a1, b1, w[3], 15);
+    R22(c2, d2, e2, a2, b2, w[10], 11);
+    R21(b1, c1, d1, e1, a1, w[12], 7);
+    R22(b2, c2, d2, e2, a2, w[14], 7);
+    R21(a1, b1, c1, d1, e1, w[0], 12);
+    R22(a2, b2, c2, d2, e2, w[15], 7);
+    R21(e1, a1, b1, c1, d1, w[9], 15);
+    R22(e2, a2, b2, c2, d2, w[8], 12);
+    R21(d1, e1, a1, b1, c1, w[5], 9);
+    R22(d2, e2, a2, b2, c2, w[12], 7);
+    R21(c1, d1, e1, a1, b1, w[2], 11);
+    R22(c2, d2, e2, a2, b2, w[4], 6);
+    R21(b1, c1, d1, e1, a1, w[14], 7);
+    R22(b2, c2, d2, e2, a2, w[9], 15);
+    R21(a1, b1, c1, d1, e1, w[11], 13);
+    R22(a2, b2, c2, d2, e2, w[1], 13);
+    R21(e1, a1, b1, c1, d1, w[8], 12);
+    R22(e2, a2, b2, c2, d2, w[2], 11);
+
+    R31(d1, e1, a1, b1, c1, w[3], 11);
+    R32(d2, e2, a2, b2, c2, w[15], 9);
+    R31(c1, d1, e1, a1, b1, w[10], 13);
+    R32(c2, d2, e2, a2, b2, w[5], 7);
+    R31(b1, c1, d1, e1, a1, w[14], 6);
+    R32(b2, c2, d2, e2, a2, w[1], 15);
+    R31(a1, b1, c1, d1, e1, w[4], 7);
+    R32(a2, b2, c2, d2, e2, w[3], 11);
+    R31(e1, a1, b1, c1, d1, w[9], 14);
+    R32(e2, a2, b2, c2, d2, w[7], 8);
+    R31(d1, e1, a1, b1, c1, w[15], 9);
+    R32(d2, e2, a2, b2, c2, w[14], 6);
+    R31(c1, d1, e1, a1, b1, w[8], 13);
+    R32(c2, d2, e2, a2, b2, w[6], 6);
+    R31(b1, c1, d1, e1, a1, w[1], 15);
+    R32(b2, c2, d2, e2, a2, w[9], 14);
+    R31(a1, b1, c1, d1, e1, w[2], 14);
+    R32(a2, b2, c2, d2, e2, w[11], 12);
+    R31(e1, a1, b1, c1, d1, w[7], 8);
+    R32(e2, a2, b2, c2, d2, w[8], 13);
+    R31(d1, e1, a1, b1, c1, w[0], 13);
+    R32(d2, e2, a2, b2, c2, w[12], 5);
+    R31(c1, d1, e1, a1, b1, w[6], 6);
+    R32(c2, d2, e2, a2, b2, w[2], 14);
+    R31(b1, c1, d1, e1, a1, w[13], 5);
+    R32(b2, c2, d2, e2, a2, w[10], 13);
+    R31(a1, b1, c1, d1, e1, w[11], 12);
+    R32(a2, b2, c2, d2, e2, w[0], 13);
+    R31(e1, a1, b1, c1, d1, w[5], 7);
+    R32(e2, a2, b2, c2, d2, w[4], 7);
+    R31(d1, e1, a1, b1, c1, w[12], 5);
+    R32(d2, e2, a2, b2, c2, w[13], 5);
+
+    R41(c1, d1, e1, a1, b1, w[1], 11);
+    R42(c2, d2, e2, a2, b2, w[8], 15);
+    R41(b1, c1, d1, e1, a1, w[9], 12);
+    R42(b2, c2, d2, e2, a2, w[6], 5);
+    R41(a1, b1, c1, d1, e1, w[11], 14);
+    R42(a2, b2, c2, d2, e2, w[4], 8);
+    R41(e1, a1, b1, c1, d1, w[10], 15);
+    R42(e2, a2, b2, c2, d2, w[1], 11);
+    R41(d1, e1, a1, b1, c1, w[0], 14);
+    R42(d2, e2, a2, b2, c2, w[3], 14);
+    R41(c1, d1, e1, a1, b1, w[8], 15);
+    R42(c2, d2, e2, a2, b2, w[11], 14);
+    R41(b1, c1, d1, e1, a1, w[12], 9);
+    R42(b2, c2, d2, e2, a2, w[15], 6);
+    R41(a1, b1, c1, d1, e1, w[4], 8);
+    R42(a2, b2, c2, d2, e2, w[0], 14);
+    R41(e1, a1, b1, c1, d1, w[13], 9);
+    R42(e2, a2, b2, c2, d2, w[5], 6);
+    R41(d1, e1, a1, b1, c1, w[3], 14);
+    R42(d2, e2, a2, b2, c2, w[12], 9);
+    R41(c1, d1, e1, a1, b1, w[7], 5);
+    R42(c2, d2, e2, a2, b2, w[2], 12);
+    R41(b1, c1, d1, e1, a1, w[15], 6);
+    R42(b2, c2, d2, e2, a2, w[13], 9);
+    R41(a1, b1, c1, d1, e1, w[14], 8);
+    R42(a2, b2, c2, d2, e2, w[9], 12);
+    R41(e1, a1, b1, c1, d1, w[5], 6);
+    R42(e2, a2, b2, c2, d2, w[7], 5);
+    R41(d1, e1, a1, b1, c1, w[6], 5);
+    R42(d2, e2, a2, b2, c2, w[10], 15);
+    R41(c1, d1, e1, a1, b1, w[2], 12);
+    R42(c2, d2, e2, a2, b2, w[14], 8);
+
+    R51(b1, c1, d1, e1, a1, w[4], 9);
+    R52(b2, c2, d2, e2, a2, w[12], 8);
+    R51(a1, b1, c1, d1, e1, w[0], 15);
+    R52(a2, b2, c2, d2, e2, w[15], 5);
+    R51(e1, a1, b1, c1, d1, w[5], 5);
+    R52(e2, a2, b2, c2, d2, w[10], 12);
+    R51(d1, e1, a1, b1, c1, w[9], 11);
+    R52(d2, e2, a2, b2, c2, w[4], 9);
+    R51(c1, d1, e1, a1, b1, w[7], 6);
+    R52(c2, d2, e2, a2, b2, w[1], 12);
+    R51(b1, c1, d1, e1, a1, w[12], 8);
+    R52(b2, c2, d2, e2, a2, w[5], 5);
+    R51(a1, b1, c1, d1, e1, w[2], 13);
+    R52(a2, b2, c2, d2, e2, w[8], 14);
+    R51(e1, a1, b1, c1, d1, w[10], 12);
+    R52(e2, a2, b2, c2, d2, w[7], 6);
+    R51(d1, e1, a1, b1, c1, w[14], 5);
+    R52(d2, e2, a2, b2, c2, w[6], 8);
+    R51(c1, d1, e1, a1, b1, w[1], 12);
+    R52(c2, d2, e2, a2, b2, w[2], 13);
+    R51(b1, c1, d1, e1, a1, w[3], 13);
+    R52(b2, c2, d2, e2, a2, w[13], 6);
+    R51(a1, b1, c1, d1, e1, w[8], 14);
+    R52(a2, b2, c2, d2, e2, w[14], 5);
+    R51(e1, a1, b1, c1, d1, w[11], 11);
+    R52(e2, a2, b2, c2, d2, w[0], 15);
+    R51(d1, e1, a1, b1, c1, w[6], 8);
+    R52(d2, e2, a2, b2, c2, w[3], 13);
+    R51(c1, d1, e1, a1, b1, w[15], 5);
+    R52(c2, d2, e2, a2, b2, w[9], 11);
+    R51(b1, c1, d1, e1, a1, w[13], 6);
+    R52(b2, c2, d2, e2, a2, w[11], 11);
+
+    r[0] = add3(_mm512_load_si512(_ripinit + 16), c1, d2);
+    r[1] = add3(_mm512_load_si512(_ripinit + 32), d1, e2);
+    r[2] = add3(_mm512_load_si512(_ripinit + 48), e1, a2);
+    r[3] = add3(_mm512_load_si512(_ripinit + 64), a1, b2);
+    r[4] = add3(_mm512_load_si512(_ripinit + 0), b1, c2);
+
+}
+
+} // end namespace
+
+// RIPEMD160 of the 16 SHA256 states s, hashes are written contiguously in h (16 x 20 bytes)
+static inline void Ripemd160Store(__m512i *s, uint8_t *h)
+{
+
+    __m512i r[5];
+#ifdef WIN64
+    __declspec(align(64)) uint32_t r32[5][16];
+#else
+    uint32_t r32[5][16] __attribute__((aligned(64)));
+#endif
+
+    _hash160avx512::Ripemd160Transform(r, s);
+
+    for (int i = 0; i < 5; i++)
+        _mm512_store_si512(r32[i], r[i]);
+
+    for (int j = 0; j < 16; j++) {
+        uint32_t *hj = (uint32_t *)(h + 20 * j);
+        hj[0] = r32[0][j];
+        hj[1] = r32[1][j];
+        hj[2] = r32[2][j];
+        hj[3] = r32[3][j];
+        hj[4] = r32[4][j];
+    }
+
+}
+
+// Hash160 of 16 padded messages of nbBlock blocks (P2SH script),
+// hashes are written contiguously in h (16 x 20 bytes)
+void hash160avx512(uint32_t *blk[16], int nbBlock, uint8_t *h)
+{
+
+    __m512i s[8];
+
+    for (int i = 0; i < 8; i++)
+        s[i] = _mm512_load_si512(_hash160avx512::_shainit + 16 * i);
+
+    _hash160avx512::Sha256Transform(s, blk, 0);
+    if (nbBlock == 2)
+        _hash160avx512::Sha256Transform(s, blk, 16);
+
+    Ripemd160Store(s, h);
+
+}
+
+// Hash160 of 16 padded 33 byte compressed keys (KEYBUFFCOMP)
+void hash160avx512_33(uint32_t *blk[16], uint8_t *h)
+{
+
+    __m512i s[8];
+
+    for (int i = 0; i < 8; i++)
+        s[i] = _mm512_load_si512(_hash160avx512::_shainit + 16 * i);
+
+    _hash160avx512::Sha256Transform33(s, blk, 0);
+
+    Ripemd160Store(s, h);
+
+}
+
+// Hash160 of 16 padded 65 byte uncompressed keys (KEYBUFFUNCOMP)
+void hash160avx512_65(uint32_t *blk[16], uint8_t *h)
+{
+
+    __m512i s[8];
+
+    for (int i = 0; i < 8; i++)
+        s[i] = _mm512_load_si512(_hash160avx512::_shainit + 16 * i);
+
+    _hash160avx512::Sha256Transform(s, blk, 0);
+    _hash160avx512::Sha256Transform65(s, blk, 16);
+
+    Ripemd160Store(s, h);
+
+}
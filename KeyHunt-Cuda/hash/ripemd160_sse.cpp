@@ -90,7 +90,8 @@ void Initialize(__m128i *s)
     memcpy(s, _init, sizeof(_init));
 }
 
-// Perform 4 RIPE in parallel using SSE2
+// Perform 4 RIPE of 32 bytes messages in parallel using SSE2
+// The padding block (w[8]..w[15]) is constant and never loaded
 void Transform(__m128i *s, uint8_t *blk[4])
 {
 
@@ -116,14 +117,14 @@ void Transform(__m128i *s, uint8_t *blk[4])
     w[5] = LOADW(5);
     w[6] = LOADW(6);
     w[7] = LOADW(7);
-    w[8] = LOADW(8);
-    w[9] = LOADW(9);
-    w[10] = LOADW(10);
-    w[11] = LOADW(11);
-    w[12] = LOADW(12);
-    w[13] = LOADW(13);
-    w[14] = LOADW(14);
-    w[15] = LOADW(15);
+    w[8] = _mm_set1_epi32(0x80);
+    w[9] = _mm_setzero_si128();
+    w[10] = _mm_setzero_si128();
+    w[11] = _mm_setzero_si128();
+    w[12] = _mm_setzero_si128();
+    w[13] = _mm_setzero_si128();
+    w[14] = _mm_set1_epi32(32 << 3);
+    w[15] = _mm_setzero_si128();
 
     R11(a1, b1, c1, d1, e1, w[0], 11);
     R12(a2, b2, c2, d2, e2, w[5], 8);
@@ -320,9 +321,6 @@ void Transform(__m128i *s, uint8_t *blk[4])
 
 #endif
 
-static const uint64_t sizedesc_32 = 32 << 3;
-static const unsigned char pad[64] = { 0x80 };
-
 void ripemd160sse_32(
         unsigned char *i0,
         unsigned char *i1,
@@ -338,15 +336,6 @@ void ripemd160sse_32(
     uint8_t *bs[] = { i0, i1, i2, i3 };
 
     ripemd160sse::Initialize(s);
-    memcpy(i0 + 32, pad, 24);
-    memcpy(i0 + 56, &sizedesc_32, 8);
-    memcpy(i1 + 32, pad, 24);
-    memcpy(i1 + 56, &sizedesc_32, 8);
-    memcpy(i2 + 32, pad, 24);
-    memcpy(i2 + 56, &sizedesc_32, 8);
-    memcpy(i3 + 32, pad, 24);
-    memcpy(i3 + 56, &sizedesc_32, 8);
-
     ripemd160sse::Transform(s, bs);
 
 #ifndef WIN64
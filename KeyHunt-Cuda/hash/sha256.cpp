@@ -490,9 +490,12 @@ void sha256_checksum(uint8_t *input, int length, uint8_t *checksum)
 
     uint32_t s[8];
     uint8_t b[64];
+    uint64_t sizedesc = _byteswap_uint64((uint64_t)length << 3);
     memcpy(b, input, length);
     memcpy(b + length, _sha256::pad, 56 - length);
-    WRITEBE64(b + 56, length << 3);
+    // Copied bytewise, a 64 bit store may not be seen by the 32 bit reads
+    // of Transform2 (strict aliasing)
+    memcpy(b + 56, &sizedesc, 8);
     _sha256::Transform2(s, b);
     WRITEBE32(checksum, s[0]);
 
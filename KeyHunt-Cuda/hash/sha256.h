@@ -27,6 +27,34 @@ void sha256sse_1B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
 void sha256sse_2B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256sse_33(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                  uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256sse_65(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                  uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256shani_1B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                    uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256shani_2B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                    uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256shani_33(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                    uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256shani_65(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                    uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
+void sha256avx2_1B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                   uint32_t *i4, uint32_t *i5, uint32_t *i6, uint32_t *i7,
+                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3,
+                   uint8_t *d4, uint8_t *d5, uint8_t *d6, uint8_t *d7);
+void sha256avx2_2B(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                   uint32_t *i4, uint32_t *i5, uint32_t *i6, uint32_t *i7,
+                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3,
+                   uint8_t *d4, uint8_t *d5, uint8_t *d6, uint8_t *d7);
+void sha256avx2_33(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                   uint32_t *i4, uint32_t *i5, uint32_t *i6, uint32_t *i7,
+                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3,
+                   uint8_t *d4, uint8_t *d5, uint8_t *d6, uint8_t *d7);
+void sha256avx2_65(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
+                   uint32_t *i4, uint32_t *i5, uint32_t *i6, uint32_t *i7,
+                   uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3,
+                   uint8_t *d4, uint8_t *d5, uint8_t *d6, uint8_t *d7);
 void sha256sse_checksum(uint32_t *i0, uint32_t *i1, uint32_t *i2, uint32_t *i3,
                         uint8_t *d0, uint8_t *d1, uint8_t *d2, uint8_t *d3);
 std::string sha256_hex(unsigned char *digest);
@@ -0,0 +1,641 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sha256.h"
+#include <immintrin.h>
+#include <string.h>
+#include <stdint.h>
+
+namespace _sha256avx2
+{
+
+
+#ifdef WIN64
+static const __declspec(align(32)) uint32_t _init[] = {
+#else
+static const uint32_t _init[] __attribute__((aligned(32))) = {
+#endif
+    0x6a09e667, 0x6a09e667, 0x6a09e667, 0x6a09e667, 0x6a09e667, 0x6a09e667, 0x6a09e667, 0x6a09e667,
+    0xbb67ae85, 0xbb67ae85, 0xbb67ae85, 0xbb67ae85, 0xbb67ae85, 0xbb67ae85, 0xbb67ae85, 0xbb67ae85,
+    0x3c6ef372, 0x3c6ef372, 0x3c6ef372, 0x3c6ef372, 0x3c6ef372, 0x3c6ef372, 0x3c6ef372, 0x3c6ef372,
+    0xa54ff53a, 0xa54ff53a, 0xa54ff53a, 0xa54ff53a, 0xa54ff53a, 0xa54ff53a, 0xa54ff53a, 0xa54ff53a,
+    0x510e527f, 0x510e527f, 0x510e527f, 0x510e527f, 0x510e527f, 0x510e527f, 0x510e527f, 0x510e527f,
+    0x9b05688c, 0x9b05688c, 0x9b05688c, 0x9b05688c, 0x9b05688c, 0x9b05688c, 0x9b05688c, 0x9b05688c,
+    0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab, 0x1f83d9ab,
+    0x5be0cd19, 0x5be0cd19, 0x5be0cd19, 0x5be0cd19, 0x5be0cd19, 0x5be0cd19, 0x5be0cd19, 0x5be0cd19
+};
+
+//#define Maj(x,y,z) ((x&y)^(x&z)^(y&z))
+//#define Ch(x,y,z)  ((x&y)^(~x&z))
+
+// The following functions are equivalent to the above
+//#define Maj(x,y,z) ((x & y) | (z & (x | y)))
+//#define Ch(x,y,z) (z ^ (x & (y ^ z)))
+
+#define Maj(b,c,d) _mm256_or_si256(_mm256_and_si256(b, c), _mm256_and_si256(d, _mm256_or_si256(b, c)) )
+#define Ch(b,c,d)  _mm256_xor_si256(_mm256_and_si256(b, c) , _mm256_andnot_si256(b , d) )
+#define ROR(x,n)   _mm256_or_si256( _mm256_srli_epi32(x, n) , _mm256_slli_epi32(x, 32 - n) )
+#define SHR(x,n)   _mm256_srli_epi32(x, n)
+
+/* SHA256 Functions */
+#define S0(x) (_mm256_xor_si256(ROR((x), 2) , _mm256_xor_si256(ROR((x), 13), ROR((x), 22))))
+#define S1(x) (_mm256_xor_si256(ROR((x), 6) , _mm256_xor_si256(ROR((x), 11), ROR((x), 25))))
+#define s0(x) (_mm256_xor_si256(ROR((x), 7) , _mm256_xor_si256(ROR((x), 18), SHR((x), 3))))
+#define s1(x) (_mm256_xor_si256(ROR((x), 17), _mm256_xor_si256(ROR((x), 19), SHR((x), 10))))
+
+#define add4(x0, x1, x2, x3) _mm256_add_epi32(_mm256_add_epi32(x0, x1), _mm256_add_epi32(x2, x3))
+#define add3(x0, x1, x2 ) _mm256_add_epi32(_mm256_add_epi32(x0, x1), x2)
+#define add5(x0, x1, x2, x3, x4) _mm256_add_epi32(add3(x0, x1, x2), _mm256_add_epi32(x3, x4))
+
+
+#define Round(a, b, c, d, e, f, g, h, i, w)                 \
+    T1 = add5(h, S1(e), Ch(e, f, g), _mm256_set1_epi32(i), w);     \
+    d = _mm256_add_epi32(d, T1);                               \
+    T2 = _mm256_add_epi32(S0(a), Maj(a, b, c));                \
+    h = _mm256_add_epi32(T1, T2);
+
+// Round with a constant message word, w is folded into the constant i
+#define RoundK(a, b, c, d, e, f, g, h, i)                   \
+    T1 = add4(h, S1(e), Ch(e, f, g), _mm256_set1_epi32(i));     \
+    d = _mm256_add_epi32(d, T1);                               \
+    T2 = _mm256_add_epi32(S0(a), Maj(a, b, c));                \
+    h = _mm256_add_epi32(T1, T2);
+
+#define WMIX() \
+  w0 = add4(s1(w14), w9, s0(w1), w0); \
+  w1 = add4(s1(w15), w10, s0(w2), w1); \
+  w2 = add4(s1(w0), w11, s0(w3), w2); \
+  w3 = add4(s1(w1), w12, s0(w4), w3); \
+  w4 = add4(s1(w2), w13, s0(w5), w4); \
+  w5 = add4(s1(w3), w14, s0(w6), w5); \
+  w6 = add4(s1(w4), w15, s0(w7), w6); \
+  w7 = add4(s1(w5), w0, s0(w8), w7); \
+  w8 = add4(s1(w6), w1, s0(w9), w8); \
+  w9 = add4(s1(w7), w2, s0(w10), w9); \
+  w10 = add4(s1(w8), w3, s0(w11), w10); \
+  w11 = add4(s1(w9), w4, s0(w12), w11); \
+  w12 = add4(s1(w10), w5, s0(w13), w12); \
+  w13 = add4(s1(w11), w6, s0(w14), w13); \
+  w14 = add4(s1(w12), w7, s0(w15), w14); \
+  w15 = add4(s1(w13), w8, s0(w0), w15);
+
+// First message schedule of a 33 byte message, w9..w14 = 0 and w15 = 0x108
+#define WMIX33() \
+  w0 = _mm256_add_epi32(s0(w1), w0); \
+  w1 = add3(_mm256_set1_epi32(0x00A50000), s0(w2), w1); \
+  w2 = add3(s1(w0), s0(w3), w2); \
+  w3 = add3(s1(w1), s0(w4), w3); \
+  w4 = add3(s1(w2), s0(w5), w4); \
+  w5 = add3(s1(w3), s0(w6), w5); \
+  w6 = add4(s1(w4), _mm256_set1_epi32(0x108), s0(w7), w6); \
+  w7 = add4(s1(w5), w0, s0(w8), w7); \
+  w8 = add3(s1(w6), w1, w8); \
+  w9 = _mm256_add_epi32(s1(w7), w2); \
+  w10 = _mm256_add_epi32(s1(w8), w3); \
+  w11 = _mm256_add_epi32(s1(w9), w4); \
+  w12 = _mm256_add_epi32(s1(w10), w5); \
+  w13 = _mm256_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm256_set1_epi32(0x10420023)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm256_set1_epi32(0x108));
+
+// First message schedule of the second block of a 65 byte message,
+// w1..w14 = 0 and w15 = 0x208 (w0 is unchanged)
+#define WMIX65() \
+  w1 = _mm256_set1_epi32(0x01450000); \
+  w2 = s1(w0); \
+  w3 = _mm256_set1_epi32(0x200051CA); \
+  w4 = s1(w2); \
+  w5 = _mm256_set1_epi32(0x22D45414); \
+  w6 = _mm256_add_epi32(s1(w4), _mm256_set1_epi32(0x208)); \
+  w7 = _mm256_add_epi32(w0, _mm256_set1_epi32(0xA0802025)); \
+  w8 = _mm256_add_epi32(s1(w6), _mm256_set1_epi32(0x01450000)); \
+  w9 = _mm256_add_epi32(s1(w7), w2); \
+  w10 = _mm256_add_epi32(s1(w8), _mm256_set1_epi32(0x200051CA)); \
+  w11 = _mm256_add_epi32(s1(w9), w4); \
+  w12 = _mm256_add_epi32(s1(w10), _mm256_set1_epi32(0x22D45414)); \
+  w13 = _mm256_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm256_set1_epi32(0x10820045)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm256_set1_epi32(0x208));
+
+#define LOADW(i) _mm256_setr_epi32(blk[0][i], blk[1][i], blk[2][i], blk[3][i], blk[4][i], blk[5][i], blk[6][i], blk[7][i])
+
+// Initialise state
+void Initialize(__m256i *s)
+{
+    memcpy(s, _init, sizeof(_init));
+}
+
+// Perform 8 SHA in parallel using AVX2
+void Transform(__m256i *s, uint32_t *blk[8])
+{
+    __m256i a, b, c, d, e, f, g, h;
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m256i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m256i T1, T2;
+
+    a = _mm256_load_si256(s + 0);
+    b = _mm256_load_si256(s + 1);
+    c = _mm256_load_si256(s + 2);
+    d = _mm256_load_si256(s + 3);
+    e = _mm256_load_si256(s + 4);
+    f = _mm256_load_si256(s + 5);
+    g = _mm256_load_si256(s + 6);
+    h = _mm256_load_si256(s + 7);
+
+    w0 = LOADW(0);
+    w1 = LOADW(1);
+    w2 = LOADW(2);
+    w3 = LOADW(3);
+    w4 = LOADW(4);
+    w5 = LOADW(5);
+    w6 = LOADW(6);
+    w7 = LOADW(7);
+    w8 = LOADW(8);
+    w9 = LOADW(9);
+    w10 = LOADW(10);
+    w11 = LOADW(11);
+    w12 = LOADW(12);
+    w13 = LOADW(13);
+    w14 = LOADW(14);
+    w15 = LOADW(15);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    Round(h, a, b, c, d, e, f, g, 0x71374491, w1);
+    Round(g, h, a, b, c, d, e, f, 0xB5C0FBCF, w2);
+    Round(f, g, h, a, b, c, d, e, 0xE9B5DBA5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x3956C25B, w4);
+    Round(d, e, f, g, h, a, b, c, 0x59F111F1, w5);
+    Round(c, d, e, f, g, h, a, b, 0x923F82A4, w6);
+    Round(b, c, d, e, f, g, h, a, 0xAB1C5ED5, w7);
+    Round(a, b, c, d, e, f, g, h, 0xD807AA98, w8);
+    Round(h, a, b, c, d, e, f, g, 0x12835B01, w9);
+    Round(g, h, a, b, c, d, e, f, 0x243185BE, w10);
+    Round(f, g, h, a, b, c, d, e, 0x550C7DC3, w11);
+    Round(e, f, g, h, a, b, c, d, 0x72BE5D74, w12);
+    Round(d, e, f, g, h, a, b, c, 0x80DEB1FE, w13);
+    Round(c, d, e, f, g, h, a, b, 0x9BDC06A7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC19BF174, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    Round(h, a, b, c, d, e, f, g, 0xEFBE4786, w1);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    Round(f, g, h, a, b, c, d, e, 0x240CA1CC, w3);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4A7484AA, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm256_add_epi32(a, s[0]);
+    s[1] = _mm256_add_epi32(b, s[1]);
+    s[2] = _mm256_add_epi32(c, s[2]);
+    s[3] = _mm256_add_epi32(d, s[3]);
+    s[4] = _mm256_add_epi32(e, s[4]);
+    s[5] = _mm256_add_epi32(f, s[5]);
+    s[6] = _mm256_add_epi32(g, s[6]);
+    s[7] = _mm256_add_epi32(h, s[7]);
+
+}
+
+// Perform 8 SHA of a padded 33 byte message (compressed key) in parallel using AVX2
+void Transform33(__m256i *s, uint32_t *blk[8])
+{
+    __m256i a, b, c, d, e, f, g, h;
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m256i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m256i T1, T2;
+
+    a = _mm256_load_si256(s + 0);
+    b = _mm256_load_si256(s + 1);
+    c = _mm256_load_si256(s + 2);
+    d = _mm256_load_si256(s + 3);
+    e = _mm256_load_si256(s + 4);
+    f = _mm256_load_si256(s + 5);
+    g = _mm256_load_si256(s + 6);
+    h = _mm256_load_si256(s + 7);
+
+    w0 = LOADW(0);
+    w1 = LOADW(1);
+    w2 = LOADW(2);
+    w3 = LOADW(3);
+    w4 = LOADW(4);
+    w5 = LOADW(5);
+    w6 = LOADW(6);
+    w7 = LOADW(7);
+    w8 = LOADW(8);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    Round(h, a, b, c, d, e, f, g, 0x71374491, w1);
+    Round(g, h, a, b, c, d, e, f, 0xB5C0FBCF, w2);
+    Round(f, g, h, a, b, c, d, e, 0xE9B5DBA5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x3956C25B, w4);
+    Round(d, e, f, g, h, a, b, c, 0x59F111F1, w5);
+    Round(c, d, e, f, g, h, a, b, 0x923F82A4, w6);
+    Round(b, c, d, e, f, g, h, a, 0xAB1C5ED5, w7);
+    Round(a, b, c, d, e, f, g, h, 0xD807AA98, w8);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF27C);
+
+    WMIX33()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    Round(h, a, b, c, d, e, f, g, 0xEFBE4786, w1);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    Round(f, g, h, a, b, c, d, e, 0x240CA1CC, w3);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4A7484AA, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm256_add_epi32(a, s[0]);
+    s[1] = _mm256_add_epi32(b, s[1]);
+    s[2] = _mm256_add_epi32(c, s[2]);
+    s[3] = _mm256_add_epi32(d, s[3]);
+    s[4] = _mm256_add_epi32(e, s[4]);
+    s[5] = _mm256_add_epi32(f, s[5]);
+    s[6] = _mm256_add_epi32(g, s[6]);
+    s[7] = _mm256_add_epi32(h, s[7]);
+
+}
+
+// Perform 8 SHA of the second block of a padded 65 byte message (uncompressed key)
+void Transform65(__m256i *s, uint32_t *blk[8])
+{
+    __m256i a, b, c, d, e, f, g, h;
+    __m256i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m256i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m256i T1, T2;
+
+    a = _mm256_load_si256(s + 0);
+    b = _mm256_load_si256(s + 1);
+    c = _mm256_load_si256(s + 2);
+    d = _mm256_load_si256(s + 3);
+    e = _mm256_load_si256(s + 4);
+    f = _mm256_load_si256(s + 5);
+    g = _mm256_load_si256(s + 6);
+    h = _mm256_load_si256(s + 7);
+
+    w0 = LOADW(0);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0x71374491);
+    RoundK(g, h, a, b, c, d, e, f, 0xB5C0FBCF);
+    RoundK(f, g, h, a, b, c, d, e, 0xE9B5DBA5);
+    RoundK(e, f, g, h, a, b, c, d, 0x3956C25B);
+    RoundK(d, e, f, g, h, a, b, c, 0x59F111F1);
+    RoundK(c, d, e, f, g, h, a, b, 0x923F82A4);
+    RoundK(b, c, d, e, f, g, h, a, 0xAB1C5ED5);
+    RoundK(a, b, c, d, e, f, g, h, 0xD807AA98);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF37C);
+
+    WMIX65()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0xF1034786);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    RoundK(f, g, h, a, b, c, d, e, 0x440CF396);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    RoundK(d, e, f, g, h, a, b, c, 0x6D48D8BE);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm256_add_epi32(a, s[0]);
+    s[1] = _mm256_add_epi32(b, s[1]);
+    s[2] = _mm256_add_epi32(c, s[2]);
+    s[3] = _mm256_add_epi32(d, s[3]);
+    s[4] = _mm256_add_epi32(e, s[4]);
+    s[5] = _mm256_add_epi32(f, s[5]);
+    s[6] = _mm256_add_epi32(g, s[6]);
+    s[7] = _mm256_add_epi32(h, s[7]);
+
+}
+
+} // end namespace
+
+// Transpose the 8 interleaved states and store the 8 big-endian digests
+static inline void Unpack(__m256i *s, unsigned char *d[8])
+{
+
+    __m256i mask = _mm256_set_epi8(12, 13, 14, 15, /**/ 8, 9, 10, 11, /**/ 4, 5, 6, 7, /**/ 0, 1, 2, 3,
+                                   12, 13, 14, 15, /**/ 8, 9, 10, 11, /**/ 4, 5, 6, 7, /**/ 0, 1, 2, 3);
+
+    __m256i t0 = _mm256_unpacklo_epi32(s[0], s[1]);  // S0_0 S1_0 S0_1 S1_1 | S0_4 S1_4 S0_5 S1_5
+    __m256i t1 = _mm256_unpackhi_epi32(s[0], s[1]);  // S0_2 S1_2 S0_3 S1_3 | S0_6 S1_6 S0_7 S1_7
+    __m256i t2 = _mm256_unpacklo_epi32(s[2], s[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(s[2], s[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(s[4], s[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(s[4], s[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(s[6], s[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(s[6], s[7]);
+
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);      // S0_0 S1_0 S2_0 S3_0 | S0_4 S1_4 S2_4 S3_4
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);      // S0_1 S1_1 S2_1 S3_1 | S0_5 S1_5 S2_5 S3_5
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);      // S0_2 S1_2 S2_2 S3_2 | S0_6 S1_6 S2_6 S3_6
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);      // S0_3 S1_3 S2_3 S3_3 | S0_7 S1_7 S2_7 S3_7
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    _mm256_storeu_si256((__m256i *)d[0], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x20), mask));
+    _mm256_storeu_si256((__m256i *)d[1], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x20), mask));
+    _mm256_storeu_si256((__m256i *)d[2], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x20), mask));
+    _mm256_storeu_si256((__m256i *)d[3], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x20), mask));
+    _mm256_storeu_si256((__m256i *)d[4], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u0, u4, 0x31), mask));
+    _mm256_storeu_si256((__m256i *)d[5], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u1, u5, 0x31), mask));
+    _mm256_storeu_si256((__m256i *)d[6], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u2, u6, 0x31), mask));
+    _mm256_storeu_si256((__m256i *)d[7], _mm256_shuffle_epi8(_mm256_permute2x128_si256(u3, u7, 0x31), mask));
+
+}
+
+// 8 x SHA256 of a single padded block (33 bytes compressed key or script)
+void sha256avx2_1B(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        uint32_t *i4,
+        uint32_t *i5,
+        uint32_t *i6,
+        uint32_t *i7,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3,
+        unsigned char *d4,
+        unsigned char *d5,
+        unsigned char *d6,
+        unsigned char *d7)
+{
+
+    __m256i s[8];
+    uint32_t *b[8] = { i0, i1, i2, i3, i4, i5, i6, i7 };
+    unsigned char *d[8] = { d0, d1, d2, d3, d4, d5, d6, d7 };
+
+    _sha256avx2::Initialize(s);
+    _sha256avx2::Transform(s, b);
+
+    Unpack(s, d);
+
+}
+
+// 8 x SHA256 of two padded blocks (65 bytes uncompressed key)
+void sha256avx2_2B(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        uint32_t *i4,
+        uint32_t *i5,
+        uint32_t *i6,
+        uint32_t *i7,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3,
+        unsigned char *d4,
+        unsigned char *d5,
+        unsigned char *d6,
+        unsigned char *d7)
+{
+
+    __m256i s[8];
+    uint32_t *b[8] = { i0, i1, i2, i3, i4, i5, i6, i7 };
+    uint32_t *b2[8] = { i0 + 16, i1 + 16, i2 + 16, i3 + 16, i4 + 16, i5 + 16, i6 + 16, i7 + 16 };
+    unsigned char *d[8] = { d0, d1, d2, d3, d4, d5, d6, d7 };
+
+    _sha256avx2::Initialize(s);
+    _sha256avx2::Transform(s, b);
+    _sha256avx2::Transform(s, b2);
+
+    Unpack(s, d);
+
+}
+
+// 8 x SHA256 of a padded 33 byte message (KEYBUFFCOMP), padding words are not read
+void sha256avx2_33(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        uint32_t *i4,
+        uint32_t *i5,
+        uint32_t *i6,
+        uint32_t *i7,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3,
+        unsigned char *d4,
+        unsigned char *d5,
+        unsigned char *d6,
+        unsigned char *d7)
+{
+
+    __m256i s[8];
+    uint32_t *b[8] = { i0, i1, i2, i3, i4, i5, i6, i7 };
+    unsigned char *d[8] = { d0, d1, d2, d3, d4, d5, d6, d7 };
+
+    _sha256avx2::Initialize(s);
+    _sha256avx2::Transform33(s, b);
+
+    Unpack(s, d);
+
+}
+
+// 8 x SHA256 of a padded 65 byte message (KEYBUFFUNCOMP), padding words are not read
+void sha256avx2_65(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        uint32_t *i4,
+        uint32_t *i5,
+        uint32_t *i6,
+        uint32_t *i7,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3,
+        unsigned char *d4,
+        unsigned char *d5,
+        unsigned char *d6,
+        unsigned char *d7)
+{
+
+    __m256i s[8];
+    uint32_t *b[8] = { i0, i1, i2, i3, i4, i5, i6, i7 };
+    uint32_t *b2[8] = { i0 + 16, i1 + 16, i2 + 16, i3 + 16, i4 + 16, i5 + 16, i6 + 16, i7 + 16 };
+    unsigned char *d[8] = { d0, d1, d2, d3, d4, d5, d6, d7 };
+
+    _sha256avx2::Initialize(s);
+    _sha256avx2::Transform(s, b);
+    _sha256avx2::Transform65(s, b2);
+
+    Unpack(s, d);
+
+}
@@ -0,0 +1,388 @@
+/*
+ * This file is part of the VanitySearch distribution (https://github.com/JeanLucPons/VanitySearch).
+ * Copyright (c) 2019 Jean Luc PONS.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "sha256.h"
+#include <immintrin.h>
+#include <string.h>
+#include <stdint.h>
+
+// SHA256 using the SHA extensions (sha256rnds2, sha256msg1/2).
+// Two independent messages are processed interleaved to hide the latency
+// of the round instructions, inputs and outputs are the same as sha256sse_xB.
+
+namespace _sha256shani
+{
+
+#ifdef WIN64
+static const __declspec(align(16)) uint32_t K[] = {
+#else
+static const uint32_t K[] __attribute__((aligned(16))) = {
+#endif
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5,
+    0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC,
+    0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7,
+    0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3,
+    0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5,
+    0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+#ifdef WIN64
+static const __declspec(align(16)) uint32_t _init[] = {
+#else
+static const uint32_t _init[] __attribute__((aligned(16))) = {
+#endif
+    // ABEF, CDGH
+    0x9b05688c, 0x510e527f, 0xbb67ae85, 0x6a09e667,
+    0x5be0cd19, 0x1f83d9ab, 0xa54ff53a, 0x3c6ef372
+};
+
+// 4 rounds on both messages
+#define QROUND(i,w) \
+    m = _mm_add_epi32(w##a, _mm_load_si128((const __m128i *)(K + 4 * (i)))); \
+    n = _mm_add_epi32(w##b, _mm_load_si128((const __m128i *)(K + 4 * (i)))); \
+    s1a = _mm_sha256rnds2_epu32(s1a, s0a, m); \
+    s1b = _mm_sha256rnds2_epu32(s1b, s0b, n); \
+    m = _mm_shuffle_epi32(m, 0x0E); \
+    n = _mm_shuffle_epi32(n, 0x0E); \
+    s0a = _mm_sha256rnds2_epu32(s0a, s1a, m); \
+    s0b = _mm_sha256rnds2_epu32(s0b, s1b, n);
+
+// 4 rounds on both messages with constant message words, kw = K + w
+#define QROUNDK(kw) \
+    m = kw; \
+    s1a = _mm_sha256rnds2_epu32(s1a, s0a, m); \
+    s1b = _mm_sha256rnds2_epu32(s1b, s0b, m); \
+    m = _mm_shuffle_epi32(m, 0x0E); \
+    s0a = _mm_sha256rnds2_epu32(s0a, s1a, m); \
+    s0b = _mm_sha256rnds2_epu32(s0b, s1b, m);
+
+// Message schedule, w = w[i-4] is replaced by w[i]
+#define QMIX(w,w3,w2,w1) \
+    w##a = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w##a, w3##a), _mm_alignr_epi8(w1##a, w2##a, 4)), w1##a); \
+    w##b = _mm_sha256msg2_epu32(_mm_add_epi32(_mm_sha256msg1_epu32(w##b, w3##b), _mm_alignr_epi8(w1##b, w2##b, 4)), w1##b);
+
+// Compress one block of 2 messages, s holds the ABEF/CDGH states of both messages
+void Transform(__m128i *s, uint32_t *ba, uint32_t *bb)
+{
+
+    __m128i s0a = s[0];
+    __m128i s1a = s[1];
+    __m128i s0b = s[2];
+    __m128i s1b = s[3];
+    __m128i m, n;
+
+    // Words are already host endian
+    __m128i W0a = _mm_loadu_si128((__m128i *)(ba + 0));
+    __m128i W1a = _mm_loadu_si128((__m128i *)(ba + 4));
+    __m128i W2a = _mm_loadu_si128((__m128i *)(ba + 8));
+    __m128i W3a = _mm_loadu_si128((__m128i *)(ba + 12));
+    __m128i W0b = _mm_loadu_si128((__m128i *)(bb + 0));
+    __m128i W1b = _mm_loadu_si128((__m128i *)(bb + 4));
+    __m128i W2b = _mm_loadu_si128((__m128i *)(bb + 8));
+    __m128i W3b = _mm_loadu_si128((__m128i *)(bb + 12));
+
+    QROUND(0, W0);
+    QROUND(1, W1);
+    QROUND(2, W2);
+    QROUND(3, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(4, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(5, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(6, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(7, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(8, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(9, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(10, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(11, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(12, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(13, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(14, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(15, W3);
+
+    s[0] = _mm_add_epi32(s[0], s0a);
+    s[1] = _mm_add_epi32(s[1], s1a);
+    s[2] = _mm_add_epi32(s[2], s0b);
+    s[3] = _mm_add_epi32(s[3], s1b);
+
+}
+
+// Compress a padded 33 byte message (compressed key) of 2 messages, w9..w14 = 0
+// and w15 = 0x108: the last 4 rounds use a constant K + w and the sha256msg1
+// terms that only depend on padding words are skipped
+void Transform33(__m128i *s, uint32_t *ba, uint32_t *bb)
+{
+
+    __m128i s0a = s[0];
+    __m128i s1a = s[1];
+    __m128i s0b = s[2];
+    __m128i s1b = s[3];
+    __m128i m, n;
+
+    __m128i W0a = _mm_loadu_si128((__m128i *)(ba + 0));
+    __m128i W1a = _mm_loadu_si128((__m128i *)(ba + 4));
+    __m128i W2a = _mm_cvtsi32_si128((int)ba[8]);
+    __m128i W3a = _mm_set_epi32(0x108, 0, 0, 0);
+    __m128i W0b = _mm_loadu_si128((__m128i *)(bb + 0));
+    __m128i W1b = _mm_loadu_si128((__m128i *)(bb + 4));
+    __m128i W2b = _mm_cvtsi32_si128((int)bb[8]);
+    __m128i W3b = W3a;
+
+    QROUND(0, W0);
+    QROUND(1, W1);
+    QROUND(2, W2);
+    QROUNDK(_mm_set_epi32(0xC19BF27C, 0x9BDC06A7, 0x80DEB1FE, 0x72BE5D74));
+    // w13..w15 of the alignr term are 0
+    W0a = _mm_sha256msg2_epu32(_mm_sha256msg1_epu32(W0a, W1a), W3a);
+    W0b = _mm_sha256msg2_epu32(_mm_sha256msg1_epu32(W0b, W1b), W3b);
+    QROUND(4, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(5, W1);
+    // sha256msg1(W2, W3) = W2
+    W2a = _mm_sha256msg2_epu32(_mm_add_epi32(W2a, _mm_alignr_epi8(W1a, W0a, 4)), W1a);
+    W2b = _mm_sha256msg2_epu32(_mm_add_epi32(W2b, _mm_alignr_epi8(W1b, W0b, 4)), W1b);
+    QROUND(6, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(7, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(8, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(9, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(10, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(11, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(12, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(13, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(14, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(15, W3);
+
+    s[0] = _mm_add_epi32(s[0], s0a);
+    s[1] = _mm_add_epi32(s[1], s1a);
+    s[2] = _mm_add_epi32(s[2], s0b);
+    s[3] = _mm_add_epi32(s[3], s1b);
+
+}
+
+// Compress the second block of a padded 65 byte message (uncompressed key) of 2 messages,
+// w1..w14 = 0 and w15 = 0x208: rounds 4 to 15 use a constant K + w and the first
+// sha256msg1/alignr terms are folded
+void Transform65(__m128i *s, uint32_t *ba, uint32_t *bb)
+{
+
+    __m128i s0a = s[0];
+    __m128i s1a = s[1];
+    __m128i s0b = s[2];
+    __m128i s1b = s[3];
+    __m128i m, n;
+
+    __m128i W0a = _mm_cvtsi32_si128((int)ba[0]);
+    __m128i W1a;
+    __m128i W2a;
+    __m128i W3a = _mm_set_epi32(0x208, 0, 0, 0);
+    __m128i W0b = _mm_cvtsi32_si128((int)bb[0]);
+    __m128i W1b;
+    __m128i W2b;
+    __m128i W3b = W3a;
+
+    QROUND(0, W0);
+    QROUNDK(_mm_load_si128((const __m128i *)(K + 4)));
+    QROUNDK(_mm_load_si128((const __m128i *)(K + 8)));
+    QROUNDK(_mm_set_epi32(0xC19BF37C, 0x9BDC06A7, 0x80DEB1FE, 0x72BE5D74));
+    // sha256msg1(W0, W1) = W0 and the alignr term is 0
+    W0a = _mm_sha256msg2_epu32(W0a, W3a);
+    W0b = _mm_sha256msg2_epu32(W0b, W3b);
+    QROUND(4, W0);
+    // sha256msg1(W1, W2) = 0
+    W1a = _mm_sha256msg2_epu32(_mm_alignr_epi8(W0a, W3a, 4), W0a);
+    W1b = _mm_sha256msg2_epu32(_mm_alignr_epi8(W0b, W3b, 4), W0b);
+    QROUND(5, W1);
+    // sha256msg1(W2, W3) = 0
+    W2a = _mm_sha256msg2_epu32(_mm_alignr_epi8(W1a, W0a, 4), W1a);
+    W2b = _mm_sha256msg2_epu32(_mm_alignr_epi8(W1b, W0b, 4), W1b);
+    QROUND(6, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(7, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(8, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(9, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(10, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(11, W3);
+    QMIX(W0, W1, W2, W3);
+    QROUND(12, W0);
+    QMIX(W1, W2, W3, W0);
+    QROUND(13, W1);
+    QMIX(W2, W3, W0, W1);
+    QROUND(14, W2);
+    QMIX(W3, W0, W1, W2);
+    QROUND(15, W3);
+
+    s[0] = _mm_add_epi32(s[0], s0a);
+    s[1] = _mm_add_epi32(s[1], s1a);
+    s[2] = _mm_add_epi32(s[2], s0b);
+    s[3] = _mm_add_epi32(s[3], s1b);
+
+}
+
+// ABEF/CDGH state to big endian digest
+void Store(__m128i s0, __m128i s1, unsigned char *d)
+{
+
+    __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m128i t = _mm_shuffle_epi32(s0, 0x1B);     // FEBA
+    s1 = _mm_shuffle_epi32(s1, 0xB1);            // DCHG
+    s0 = _mm_blend_epi16(t, s1, 0xF0);           // DCBA
+    s1 = _mm_alignr_epi8(s1, t, 8);              // HGFE
+    _mm_storeu_si128((__m128i *)d, _mm_shuffle_epi8(s0, mask));
+    _mm_storeu_si128((__m128i *)(d + 16), _mm_shuffle_epi8(s1, mask));
+
+}
+
+void Hash(uint32_t *ba, uint32_t *bb, int nbBlock, unsigned char *da, unsigned char *db)
+{
+
+    __m128i s[4];
+
+    s[0] = _mm_load_si128((const __m128i *)(_init + 0));
+    s[1] = _mm_load_si128((const __m128i *)(_init + 4));
+    s[2] = s[0];
+    s[3] = s[1];
+
+    Transform(s, ba, bb);
+    if (nbBlock == 2)
+        Transform(s, ba + 16, bb + 16);
+
+    Store(s[0], s[1], da);
+    Store(s[2], s[3], db);
+
+}
+
+// Padded 33 byte (compressed) or 65 byte (uncompressed) keys
+void HashKey(uint32_t *ba, uint32_t *bb, bool compressed, unsigned char *da, unsigned char *db)
+{
+
+    __m128i s[4];
+
+    s[0] = _mm_load_si128((const __m128i *)(_init + 0));
+    s[1] = _mm_load_si128((const __m128i *)(_init + 4));
+    s[2] = s[0];
+    s[3] = s[1];
+
+    if (compressed) {
+        Transform33(s, ba, bb);
+    } else {
+        Transform(s, ba, bb);
+        Transform65(s, ba + 16, bb + 16);
+    }
+
+    Store(s[0], s[1], da);
+    Store(s[2], s[3], db);
+
+}
+
+} // end namespace
+
+void sha256shani_1B(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
+
+    _sha256shani::Hash(i0, i1, 1, d0, d1);
+    _sha256shani::Hash(i2, i3, 1, d2, d3);
+
+}
+
+void sha256shani_2B(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
+
+    _sha256shani::Hash(i0, i1, 2, d0, d1);
+    _sha256shani::Hash(i2, i3, 2, d2, d3);
+
+}
+
+void sha256shani_33(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
+
+    _sha256shani::HashKey(i0, i1, true, d0, d1);
+    _sha256shani::HashKey(i2, i3, true, d2, d3);
+
+}
+
+void sha256shani_65(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
+
+    _sha256shani::HashKey(i0, i1, false, d0, d1);
+    _sha256shani::HashKey(i2, i3, false, d2, d3);
+
+}
@@ -68,6 +68,13 @@ static const uint32_t _init[] __attribute__((aligned(16))) = {
     T2 = _mm_add_epi32(S0(a), Maj(a, b, c));                \
     h = _mm_add_epi32(T1, T2);
 
+// Round with a constant message word, w is folded into the constant i
+#define RoundK(a, b, c, d, e, f, g, h, i)                   \
+    T1 = add4(h, S1(e), Ch(e, f, g), _mm_set1_epi32(i));     \
+    d = _mm_add_epi32(d, T1);                               \
+    T2 = _mm_add_epi32(S0(a), Maj(a, b, c));                \
+    h = _mm_add_epi32(T1, T2);
+
 #define WMIX() \
   w0 = add4(s1(w14), w9, s0(w1), w0); \
   w1 = add4(s1(w15), w10, s0(w2), w1); \
@@ -86,6 +93,44 @@ static const uint32_t _init[] __attribute__((aligned(16))) = {
   w14 = add4(s1(w12), w7, s0(w15), w14); \
   w15 = add4(s1(w13), w8, s0(w0), w15);
 
+// First message schedule of a 33 byte message, w9..w14 = 0 and w15 = 0x108
+#define WMIX33() \
+  w0 = _mm_add_epi32(s0(w1), w0); \
+  w1 = add3(_mm_set1_epi32(0x00A50000), s0(w2), w1); \
+  w2 = add3(s1(w0), s0(w3), w2); \
+  w3 = add3(s1(w1), s0(w4), w3); \
+  w4 = add3(s1(w2), s0(w5), w4); \
+  w5 = add3(s1(w3), s0(w6), w5); \
+  w6 = add4(s1(w4), _mm_set1_epi32(0x108), s0(w7), w6); \
+  w7 = add4(s1(w5), w0, s0(w8), w7); \
+  w8 = add3(s1(w6), w1, w8); \
+  w9 = _mm_add_epi32(s1(w7), w2); \
+  w10 = _mm_add_epi32(s1(w8), w3); \
+  w11 = _mm_add_epi32(s1(w9), w4); \
+  w12 = _mm_add_epi32(s1(w10), w5); \
+  w13 = _mm_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm_set1_epi32(0x10420023)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm_set1_epi32(0x108));
+
+// First message schedule of the second block of a 65 byte message,
+// w1..w14 = 0 and w15 = 0x208 (w0 is unchanged)
+#define WMIX65() \
+  w1 = _mm_set1_epi32(0x01450000); \
+  w2 = s1(w0); \
+  w3 = _mm_set1_epi32(0x200051CA); \
+  w4 = s1(w2); \
+  w5 = _mm_set1_epi32(0x22D45414); \
+  w6 = _mm_add_epi32(s1(w4), _mm_set1_epi32(0x208)); \
+  w7 = _mm_add_epi32(w0, _mm_set1_epi32(0xA0802025)); \
+  w8 = _mm_add_epi32(s1(w6), _mm_set1_epi32(0x01450000)); \
+  w9 = _mm_add_epi32(s1(w7), w2); \
+  w10 = _mm_add_epi32(s1(w8), _mm_set1_epi32(0x200051CA)); \
+  w11 = _mm_add_epi32(s1(w9), w4); \
+  w12 = _mm_add_epi32(s1(w10), _mm_set1_epi32(0x22D45414)); \
+  w13 = _mm_add_epi32(s1(w11), w6); \
+  w14 = add3(s1(w12), w7, _mm_set1_epi32(0x10820045)); \
+  w15 = add4(s1(w13), w8, s0(w0), _mm_set1_epi32(0x208));
+
 // Initialise state
 void Initialize(__m128i *s)
 {
@@ -211,6 +256,222 @@ void Transform(__m128i *s, uint32_t *b0, uint32_t *b1, uint32_t *b2, uint32_t *b
 
 }
 
+// Perform 4 SHA of a padded 33 byte message (compressed key) in parallel using SSE2
+void Transform33(__m128i *s, uint32_t *b0, uint32_t *b1, uint32_t *b2, uint32_t *b3)
+{
+    __m128i a, b, c, d, e, f, g, h;
+    __m128i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m128i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m128i T1, T2;
+
+    a = _mm_load_si128(s + 0);
+    b = _mm_load_si128(s + 1);
+    c = _mm_load_si128(s + 2);
+    d = _mm_load_si128(s + 3);
+    e = _mm_load_si128(s + 4);
+    f = _mm_load_si128(s + 5);
+    g = _mm_load_si128(s + 6);
+    h = _mm_load_si128(s + 7);
+
+    w0 = _mm_set_epi32(b0[0], b1[0], b2[0], b3[0]);
+    w1 = _mm_set_epi32(b0[1], b1[1], b2[1], b3[1]);
+    w2 = _mm_set_epi32(b0[2], b1[2], b2[2], b3[2]);
+    w3 = _mm_set_epi32(b0[3], b1[3], b2[3], b3[3]);
+    w4 = _mm_set_epi32(b0[4], b1[4], b2[4], b3[4]);
+    w5 = _mm_set_epi32(b0[5], b1[5], b2[5], b3[5]);
+    w6 = _mm_set_epi32(b0[6], b1[6], b2[6], b3[6]);
+    w7 = _mm_set_epi32(b0[7], b1[7], b2[7], b3[7]);
+    w8 = _mm_set_epi32(b0[8], b1[8], b2[8], b3[8]);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    Round(h, a, b, c, d, e, f, g, 0x71374491, w1);
+    Round(g, h, a, b, c, d, e, f, 0xB5C0FBCF, w2);
+    Round(f, g, h, a, b, c, d, e, 0xE9B5DBA5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x3956C25B, w4);
+    Round(d, e, f, g, h, a, b, c, 0x59F111F1, w5);
+    Round(c, d, e, f, g, h, a, b, 0x923F82A4, w6);
+    Round(b, c, d, e, f, g, h, a, 0xAB1C5ED5, w7);
+    Round(a, b, c, d, e, f, g, h, 0xD807AA98, w8);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF27C);
+
+    WMIX33()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    Round(h, a, b, c, d, e, f, g, 0xEFBE4786, w1);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    Round(f, g, h, a, b, c, d, e, 0x240CA1CC, w3);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4A7484AA, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm_add_epi32(a, s[0]);
+    s[1] = _mm_add_epi32(b, s[1]);
+    s[2] = _mm_add_epi32(c, s[2]);
+    s[3] = _mm_add_epi32(d, s[3]);
+    s[4] = _mm_add_epi32(e, s[4]);
+    s[5] = _mm_add_epi32(f, s[5]);
+    s[6] = _mm_add_epi32(g, s[6]);
+    s[7] = _mm_add_epi32(h, s[7]);
+
+}
+
+// Perform 4 SHA of the second block of a padded 65 byte message (uncompressed key)
+void Transform65(__m128i *s, uint32_t *b0, uint32_t *b1, uint32_t *b2, uint32_t *b3)
+{
+    __m128i a, b, c, d, e, f, g, h;
+    __m128i w0, w1, w2, w3, w4, w5, w6, w7;
+    __m128i w8, w9, w10, w11, w12, w13, w14, w15;
+    __m128i T1, T2;
+
+    a = _mm_load_si128(s + 0);
+    b = _mm_load_si128(s + 1);
+    c = _mm_load_si128(s + 2);
+    d = _mm_load_si128(s + 3);
+    e = _mm_load_si128(s + 4);
+    f = _mm_load_si128(s + 5);
+    g = _mm_load_si128(s + 6);
+    h = _mm_load_si128(s + 7);
+
+    w0 = _mm_set_epi32(b0[0], b1[0], b2[0], b3[0]);
+
+    Round(a, b, c, d, e, f, g, h, 0x428A2F98, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0x71374491);
+    RoundK(g, h, a, b, c, d, e, f, 0xB5C0FBCF);
+    RoundK(f, g, h, a, b, c, d, e, 0xE9B5DBA5);
+    RoundK(e, f, g, h, a, b, c, d, 0x3956C25B);
+    RoundK(d, e, f, g, h, a, b, c, 0x59F111F1);
+    RoundK(c, d, e, f, g, h, a, b, 0x923F82A4);
+    RoundK(b, c, d, e, f, g, h, a, 0xAB1C5ED5);
+    RoundK(a, b, c, d, e, f, g, h, 0xD807AA98);
+    RoundK(h, a, b, c, d, e, f, g, 0x12835B01);
+    RoundK(g, h, a, b, c, d, e, f, 0x243185BE);
+    RoundK(f, g, h, a, b, c, d, e, 0x550C7DC3);
+    RoundK(e, f, g, h, a, b, c, d, 0x72BE5D74);
+    RoundK(d, e, f, g, h, a, b, c, 0x80DEB1FE);
+    RoundK(c, d, e, f, g, h, a, b, 0x9BDC06A7);
+    RoundK(b, c, d, e, f, g, h, a, 0xC19BF37C);
+
+    WMIX65()
+
+    Round(a, b, c, d, e, f, g, h, 0xE49B69C1, w0);
+    RoundK(h, a, b, c, d, e, f, g, 0xF1034786);
+    Round(g, h, a, b, c, d, e, f, 0x0FC19DC6, w2);
+    RoundK(f, g, h, a, b, c, d, e, 0x440CF396);
+    Round(e, f, g, h, a, b, c, d, 0x2DE92C6F, w4);
+    RoundK(d, e, f, g, h, a, b, c, 0x6D48D8BE);
+    Round(c, d, e, f, g, h, a, b, 0x5CB0A9DC, w6);
+    Round(b, c, d, e, f, g, h, a, 0x76F988DA, w7);
+    Round(a, b, c, d, e, f, g, h, 0x983E5152, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA831C66D, w9);
+    Round(g, h, a, b, c, d, e, f, 0xB00327C8, w10);
+    Round(f, g, h, a, b, c, d, e, 0xBF597FC7, w11);
+    Round(e, f, g, h, a, b, c, d, 0xC6E00BF3, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD5A79147, w13);
+    Round(c, d, e, f, g, h, a, b, 0x06CA6351, w14);
+    Round(b, c, d, e, f, g, h, a, 0x14292967, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x27B70A85, w0);
+    Round(h, a, b, c, d, e, f, g, 0x2E1B2138, w1);
+    Round(g, h, a, b, c, d, e, f, 0x4D2C6DFC, w2);
+    Round(f, g, h, a, b, c, d, e, 0x53380D13, w3);
+    Round(e, f, g, h, a, b, c, d, 0x650A7354, w4);
+    Round(d, e, f, g, h, a, b, c, 0x766A0ABB, w5);
+    Round(c, d, e, f, g, h, a, b, 0x81C2C92E, w6);
+    Round(b, c, d, e, f, g, h, a, 0x92722C85, w7);
+    Round(a, b, c, d, e, f, g, h, 0xA2BFE8A1, w8);
+    Round(h, a, b, c, d, e, f, g, 0xA81A664B, w9);
+    Round(g, h, a, b, c, d, e, f, 0xC24B8B70, w10);
+    Round(f, g, h, a, b, c, d, e, 0xC76C51A3, w11);
+    Round(e, f, g, h, a, b, c, d, 0xD192E819, w12);
+    Round(d, e, f, g, h, a, b, c, 0xD6990624, w13);
+    Round(c, d, e, f, g, h, a, b, 0xF40E3585, w14);
+    Round(b, c, d, e, f, g, h, a, 0x106AA070, w15);
+
+    WMIX()
+
+    Round(a, b, c, d, e, f, g, h, 0x19A4C116, w0);
+    Round(h, a, b, c, d, e, f, g, 0x1E376C08, w1);
+    Round(g, h, a, b, c, d, e, f, 0x2748774C, w2);
+    Round(f, g, h, a, b, c, d, e, 0x34B0BCB5, w3);
+    Round(e, f, g, h, a, b, c, d, 0x391C0CB3, w4);
+    Round(d, e, f, g, h, a, b, c, 0x4ED8AA4A, w5);
+    Round(c, d, e, f, g, h, a, b, 0x5B9CCA4F, w6);
+    Round(b, c, d, e, f, g, h, a, 0x682E6FF3, w7);
+    Round(a, b, c, d, e, f, g, h, 0x748F82EE, w8);
+    Round(h, a, b, c, d, e, f, g, 0x78A5636F, w9);
+    Round(g, h, a, b, c, d, e, f, 0x84C87814, w10);
+    Round(f, g, h, a, b, c, d, e, 0x8CC70208, w11);
+    Round(e, f, g, h, a, b, c, d, 0x90BEFFFA, w12);
+    Round(d, e, f, g, h, a, b, c, 0xA4506CEB, w13);
+    Round(c, d, e, f, g, h, a, b, 0xBEF9A3F7, w14);
+    Round(b, c, d, e, f, g, h, a, 0xC67178F2, w15);
+
+    s[0] = _mm_add_epi32(a, s[0]);
+    s[1] = _mm_add_epi32(b, s[1]);
+    s[2] = _mm_add_epi32(c, s[2]);
+    s[3] = _mm_add_epi32(d, s[3]);
+    s[4] = _mm_add_epi32(e, s[4]);
+    s[5] = _mm_add_epi32(f, s[5]);
+    s[6] = _mm_add_epi32(g, s[6]);
+    s[7] = _mm_add_epi32(h, s[7]);
+
+}
+
 // Perform 4 SHA(SHA(bi))[0] in parallel using SSE2
 void Transform2(__m128i *s, uint32_t *b0, uint32_t *b1, uint32_t *b2, uint32_t *b3)
 {
@@ -425,23 +686,10 @@ void Transform2(__m128i *s, uint32_t *b0, uint32_t *b1, uint32_t *b2, uint32_t *
 
 } // end namespace
 
-void sha256sse_1B(
-        uint32_t *i0,
-        uint32_t *i1,
-        uint32_t *i2,
-        uint32_t *i3,
-        unsigned char *d0,
-        unsigned char *d1,
-        unsigned char *d2,
-        unsigned char *d3)
+// Transpose the 4 interleaved states and store the 4 big-endian digests
+static inline void Unpack(__m128i *s, unsigned char *d0, unsigned char *d1, unsigned char *d2, unsigned char *d3)
 {
 
-    __m128i s[8];
-
-    _sha256sse::Initialize(s);
-    _sha256sse::Transform(s, i0, i1, i2, i3);
-
-    // Unpack
     __m128i mask = _mm_set_epi8(12, 13, 14, 15, /**/ 4, 5, 6, 7,  /**/ 8, 9, 10, 11,  /**/ 0, 1, 2, 3);
 
     __m128i u0 = _mm_unpacklo_epi32(s[0], s[1]);   // S2_1 S2_0 S3_1 S3_0
@@ -490,8 +738,7 @@ void sha256sse_1B(
 
 }
 
-
-void sha256sse_2B(
+void sha256sse_1B(
         uint32_t *i0,
         uint32_t *i1,
         uint32_t *i2,
@@ -506,54 +753,68 @@ void sha256sse_2B(
 
     _sha256sse::Initialize(s);
     _sha256sse::Transform(s, i0, i1, i2, i3);
-    _sha256sse::Transform(s, i0 + 16, i1 + 16, i2 + 16, i3 + 16);
+    Unpack(s, d0, d1, d2, d3);
 
-    // Unpack
-    __m128i mask = _mm_set_epi8(12, 13, 14, 15, /**/ 4, 5, 6, 7,  /**/ 8, 9, 10, 11,  /**/ 0, 1, 2, 3);
+}
 
-    __m128i u0 = _mm_unpacklo_epi32(s[0], s[1]);   // S2_1 S2_0 S3_1 S3_0
-    __m128i u1 = _mm_unpackhi_epi32(s[0], s[1]);   // S0_1 S0_0 S1_1 S1_0
+void sha256sse_2B(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
 
-    __m128i u2 = _mm_unpacklo_epi32(s[2], s[3]);   // S2_3 S2_2 S3_3 S3_2
-    __m128i u3 = _mm_unpackhi_epi32(s[2], s[3]);   // S0_3 S0_2 S1_3 S1_2
+    __m128i s[8];
 
-    __m128i _d3 = _mm_unpacklo_epi32(u0, u2);      // S3_3 S3_1 S3_2 S3_0
-    __m128i _d2 = _mm_unpackhi_epi32(u0, u2);      // S2_3 S2_1 S2_2 S2_0
-    __m128i _d1 = _mm_unpacklo_epi32(u1, u3);      // S1_3 S1_1 S1_2 S1_0
-    __m128i _d0 = _mm_unpackhi_epi32(u1, u3);      // S0_3 S0_1 S0_2 S0_0
+    _sha256sse::Initialize(s);
+    _sha256sse::Transform(s, i0, i1, i2, i3);
+    _sha256sse::Transform(s, i0 + 16, i1 + 16, i2 + 16, i3 + 16);
+    Unpack(s, d0, d1, d2, d3);
 
-    _d0 = _mm_shuffle_epi8(_d0, mask);
-    _d1 = _mm_shuffle_epi8(_d1, mask);
-    _d2 = _mm_shuffle_epi8(_d2, mask);
-    _d3 = _mm_shuffle_epi8(_d3, mask);
+}
 
-    _mm_store_si128((__m128i *)d0, _d0);
-    _mm_store_si128((__m128i *)d1, _d1);
-    _mm_store_si128((__m128i *)d2, _d2);
-    _mm_store_si128((__m128i *)d3, _d3);
+// 4 x SHA256 of a padded 33 byte message (KEYBUFFCOMP), padding words are not read
+void sha256sse_33(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
 
-    // --------------------
+    __m128i s[8];
 
-    u0 = _mm_unpacklo_epi32(s[4], s[5]);
-    u1 = _mm_unpackhi_epi32(s[4], s[5]);
+    _sha256sse::Initialize(s);
+    _sha256sse::Transform33(s, i0, i1, i2, i3);
+    Unpack(s, d0, d1, d2, d3);
 
-    u2 = _mm_unpacklo_epi32(s[6], s[7]);
-    u3 = _mm_unpackhi_epi32(s[6], s[7]);
+}
 
-    _d3 = _mm_unpacklo_epi32(u0, u2);
-    _d2 = _mm_unpackhi_epi32(u0, u2);
-    _d1 = _mm_unpacklo_epi32(u1, u3);
-    _d0 = _mm_unpackhi_epi32(u1, u3);
+// 4 x SHA256 of a padded 65 byte message (KEYBUFFUNCOMP), padding words are not read
+void sha256sse_65(
+        uint32_t *i0,
+        uint32_t *i1,
+        uint32_t *i2,
+        uint32_t *i3,
+        unsigned char *d0,
+        unsigned char *d1,
+        unsigned char *d2,
+        unsigned char *d3)
+{
 
-    _d0 = _mm_shuffle_epi8(_d0, mask);
-    _d1 = _mm_shuffle_epi8(_d1, mask);
-    _d2 = _mm_shuffle_epi8(_d2, mask);
-    _d3 = _mm_shuffle_epi8(_d3, mask);
+    __m128i s[8];
 
-    _mm_store_si128((__m128i *)(d0 + 16), _d0);
-    _mm_store_si128((__m128i *)(d1 + 16), _d1);
-    _mm_store_si128((__m128i *)(d2 + 16), _d2);
-    _mm_store_si128((__m128i *)(d3 + 16), _d3);
+    _sha256sse::Initialize(s);
+    _sha256sse::Transform(s, i0, i1, i2, i3);
+    _sha256sse::Transform65(s, i0 + 16, i1 + 16, i2 + 16, i3 + 16);
+    Unpack(s, d0, d1, d2, d3);
 
 }
 